@@ -0,0 +1,132 @@
+#ifndef BINARYANGLE_HPP
+#define BINARYANGLE_HPP
+
+#include <stdint.h>
+#include <cmath>
+#include <base/Angle.hpp>
+
+namespace vfh_star {
+
+/**
+ * Heading stored as a fraction of a full turn in 32 bits.
+ *
+ * A full turn is 2^32 units, so wrapping around is done by the
+ * unsigned integer overflow and never needs a normalization.
+ * The resolution is about 1.5e-9 rad.
+ *
+ * Used for the heading bookkeeping inside of the search,
+ * base::Angle is only used at the public interfaces.
+ * */
+class BinaryAngle
+{
+public:
+    BinaryAngle() : value(0)
+    {
+    }
+
+    static BinaryAngle fromRaw(uint32_t value)
+    {
+        BinaryAngle ret;
+        ret.value = value;
+        return ret;
+    }
+
+    static BinaryAngle fromRad(double rad)
+    {
+        //go through int64 so that negative angles wrap around
+        return fromRaw(static_cast<uint32_t>(static_cast<int64_t>(floor(rad * unitsPerRad() + 0.5))));
+    }
+
+    static BinaryAngle fromAngle(const base::Angle &angle)
+    {
+        return fromRad(angle.getRad());
+    }
+
+    uint32_t getRaw() const
+    {
+        return value;
+    }
+
+    /**
+     * Returns the angle in [-PI, PI)
+     * */
+    double getRad() const
+    {
+        return static_cast<int32_t>(value) / unitsPerRad();
+    }
+
+    /**
+     * Returns the angle in [0, 2*PI)
+     * */
+    double getPositiveRad() const
+    {
+        return value / unitsPerRad();
+    }
+
+    base::Angle toAngle() const
+    {
+        return base::Angle::fromRad(getRad());
+    }
+
+    /**
+     * Returns the bin of the angle, if the
+     * full turn is divided into the given number of bins.
+     * The first bin starts at zero.
+     * */
+    int getBin(int bins) const
+    {
+        return (static_cast<uint64_t>(value) * bins) >> 32;
+    }
+
+    BinaryAngle operator+(const BinaryAngle &other) const
+    {
+        return fromRaw(value + other.value);
+    }
+
+    BinaryAngle operator-(const BinaryAngle &other) const
+    {
+        return fromRaw(value - other.value);
+    }
+
+    BinaryAngle &operator+=(const BinaryAngle &other)
+    {
+        value += other.value;
+        return *this;
+    }
+
+    BinaryAngle &operator-=(const BinaryAngle &other)
+    {
+        value -= other.value;
+        return *this;
+    }
+
+    bool operator==(const BinaryAngle &other) const
+    {
+        return value == other.value;
+    }
+
+    bool operator!=(const BinaryAngle &other) const
+    {
+        return value != other.value;
+    }
+
+    /**
+     * Orders the angles by their position in [0, 2*PI)
+     * */
+    bool operator<(const BinaryAngle &other) const
+    {
+        return value < other.value;
+    }
+
+private:
+    static double unitsPerRad()
+    {
+        return 4294967296.0 / (2 * M_PI);
+    }
+
+    uint32_t value;
+};
+
+}
+
+#endif // BINARYANGLE_HPP
@@ -0,0 +1,117 @@
+#include "BudgetController.hpp"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace vfh_star {
+
+/**
+ * Returns the nearest rank percentile of the values
+ * */
+static double getPercentile(std::vector<double> &values, double percentile)
+{
+    std::sort(values.begin(), values.end());
+    const int rank = ceil(percentile * values.size());
+    return values[std::max(1, std::min<int>(values.size(), rank)) - 1];
+}
+
+/**
+ * Returns true if both configurations lead to the same budgets
+ * */
+static bool isSameConfig(const BudgetControlConf &a, const BudgetControlConf &b)
+{
+    return a.targetLatency == b.targetLatency && a.percentile == b.percentile
+        && a.window == b.window && a.minTreeSize == b.minTreeSize
+        && a.maxTreeSize == b.maxTreeSize && a.minSamplingScale == b.minSamplingScale
+        && a.maxHeuristicWeight == b.maxHeuristicWeight;
+}
+
+BudgetController::BudgetController() : maxTreeSize(0), nextSearch(0)
+{
+}
+
+void BudgetController::setConfig(const BudgetControlConf& conf, int maxTreeSize)
+{
+    //the measured searches stay valid, e.g. if only the
+    //sampling of the search configuration changed
+    if(isSameConfig(conf, this->conf) && maxTreeSize == this->maxTreeSize)
+        return;
+
+    this->conf = conf;
+    this->maxTreeSize = maxTreeSize;
+    reset();
+}
+
+void BudgetController::reset()
+{
+    window.clear();
+    nextSearch = 0;
+    stats = BudgetStats();
+    stats.nodeBudget = getMaxTreeSize();
+}
+
+int BudgetController::getMaxTreeSize() const
+{
+    if(conf.maxTreeSize > 0)
+        return conf.maxTreeSize;
+    return maxTreeSize > 0 ? maxTreeSize : std::numeric_limits<int>::max();
+}
+
+void BudgetController::addSearch(const base::Time& setupTime, const base::Time& searchTime, int expansions, int treeSize)
+{
+    if(!isEnabled())
+        return;
+
+    Search search;
+    search.setupTime = setupTime;
+    search.latency = searchTime;
+    search.expansions = expansions;
+    search.treeSize = treeSize;
+
+    const size_t windowSize = std::max(1, conf.window);
+    if(window.size() < windowSize)
+        window.push_back(search);
+    else
+        window[nextSearch] = search;
+    nextSearch = (nextSearch + 1) % windowSize;
+
+    stats.lastLatency = searchTime;
+    update();
+}
+
+void BudgetController::update()
+{
+    std::vector<double> latencies;
+    std::vector<double> setupTimes;
+    std::vector<double> nsPerNode;
+    double loopTime = 0;
+    long expansions = 0;
+    for(std::vector<Search>::const_iterator it = window.begin(); it != window.end(); it++)
+    {
+        const double setup = it->setupTime.toMicroseconds();
+        const double latency = it->latency.toMicroseconds();
+        latencies.push_back(latency);
+        setupTimes.push_back(setup);
+        nsPerNode.push_back((latency - setup) * 1000.0 / std::max(1, it->treeSize));
+        loopTime += latency - setup;
+        expansions += it->expansions;
+    }
+
+    stats.plans = window.size();
+    stats.latencyPercentile = base::Time::fromMicroseconds(getPercentile(latencies, conf.percentile));
+    stats.setupPercentile = base::Time::fromMicroseconds(getPercentile(setupTimes, conf.percentile));
+    stats.nsPerExpansion = loopTime * 1000.0 / std::max(1L, expansions);
+    stats.nsPerNode = getPercentile(nsPerNode, conf.percentile);
+
+    //the nodes that fit into the target after the setup
+    const double available = conf.targetLatency.toMicroseconds() - stats.setupPercentile.toMicroseconds();
+    const double nodes = std::max(0.0, available * 1000.0 / std::max(1.0, stats.nsPerNode));
+
+    const int minTreeSize = std::max(1, std::min(conf.minTreeSize, getMaxTreeSize()));
+    stats.nodeBudget = std::max<double>(minTreeSize, std::min<double>(getMaxTreeSize(), nodes));
+    stats.overload = nodes < minTreeSize ? 1.0 - nodes / minTreeSize : 0.0;
+    stats.samplingScale = 1.0 - stats.overload * (1.0 - conf.minSamplingScale);
+    stats.heuristicWeight = 1.0 + stats.overload * (conf.maxHeuristicWeight - 1.0);
+}
+
+}
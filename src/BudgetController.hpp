@@ -0,0 +1,99 @@
+#ifndef BUDGETCONTROLLER_HPP
+#define BUDGETCONTROLLER_HPP
+
+#include <vector>
+#include <base/Time.hpp>
+#include "Types.h"
+
+namespace vfh_star {
+
+/**
+ * Derives the work budget of the next search from the
+ * search times of the recent searches.
+ *
+ * The search time is split into the setup, which does not depend on
+ * the budget, and the time per tree node. The node budget is the
+ * number of nodes that fit into the target latency, if the setup and
+ * the time per node take their percentile values of the window. So
+ * the budget shrinks on contended hardware and grows up to the
+ * maximum tree size on idle hardware.
+ *
+ * If the budget falls below the minimum tree size, the overload is
+ * passed on to the sampling density and the heuristic weight, which
+ * make each node cheaper and direct the search towards the goal.
+ * */
+class BudgetController
+{
+public:
+    BudgetController();
+
+    /**
+     * Sets the configuration and resets the controller, if the
+     * configuration or the maxTreeSize changed. Otherwise the
+     * measured searches are kept. The maxTreeSize is the budget of
+     * the first search, and the upper limit of the budget if the
+     * configuration does not give one. Zero means no limit.
+     * */
+    void setConfig(const BudgetControlConf &conf, int maxTreeSize);
+
+    /**
+     * Forgets all measured searches
+     * */
+    void reset();
+
+    bool isEnabled() const
+    {
+        return !conf.targetLatency.isNull();
+    }
+
+    /**
+     * Adds the measurement of a search and updates the decisions
+     * for the next one
+     * */
+    void addSearch(const base::Time &setupTime, const base::Time &searchTime, int expansions, int treeSize);
+
+    int getNodeBudget() const
+    {
+        return stats.nodeBudget;
+    }
+
+    double getSamplingScale() const
+    {
+        return stats.samplingScale;
+    }
+
+    double getHeuristicWeight() const
+    {
+        return stats.heuristicWeight;
+    }
+
+    const BudgetStats &getStats() const
+    {
+        return stats;
+    }
+
+private:
+    struct Search
+    {
+        base::Time setupTime;
+        base::Time latency;
+        int expansions;
+        int treeSize;
+    };
+
+    void update();
+    int getMaxTreeSize() const;
+
+    BudgetControlConf conf;
+    int maxTreeSize;
+
+    ///ring buffer of the recent searches
+    std::vector<Search> window;
+    size_t nextSearch;
+
+    BudgetStats stats;
+};
+
+}
+
+#endif // BUDGETCONTROLLER_HPP
@@ -0,0 +1,156 @@
+#include "ConcurrentNNLookup.hpp"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace vfh_star {
+
+const uint64_t ConcurrentNNLookup::emptyKey;
+const uint64_t ConcurrentNNLookup::emptyValue;
+
+ConcurrentNNLookup::ConcurrentNNLookup(double resolutionXY, double resolutionTheta, size_t capacity) :
+    resolutionXY(resolutionXY)
+{
+    angleCells = ceil(2 * M_PI / resolutionTheta);
+
+    //power of two with a load factor of at most 0.5
+    size_t size = 16;
+    while(size < capacity * 2)
+        size *= 2;
+
+    mask = size - 1;
+    slots.resize(size);
+    clear();
+}
+
+void ConcurrentNNLookup::clear()
+{
+    for(std::vector<Slot>::iterator it = slots.begin(); it != slots.end(); it++)
+    {
+        it->key = emptyKey;
+        it->value = emptyValue;
+    }
+}
+
+uint64_t ConcurrentNNLookup::getKey(const base::Vector3d& position, const BinaryAngle& yaw, uint8_t driveModeNr) const
+{
+    const int64_t x = floor(position.x() / resolutionXY);
+    const int64_t y = floor(position.y() / resolutionXY);
+    const int64_t a = yaw.getBin(angleCells);
+
+    //24 bits per axis, 10 bits for the angle and 6 bits for the drive
+    //mode. The key is never zero, as one is added to it
+    return (((static_cast<uint64_t>(x) & 0xffffff) << 40) |
+            ((static_cast<uint64_t>(y) & 0xffffff) << 16) |
+            ((static_cast<uint64_t>(a) & 0x3ff) << 6) |
+            (driveModeNr & 0x3f)) + 1;
+}
+
+uint64_t ConcurrentNNLookup::packValue(int index, double cost)
+{
+    //the bits of non negative floats are ordered like their
+    //values, so the packed values can be compared as integers
+    const float costF = cost;
+    uint32_t costBits;
+    memcpy(&costBits, &costF, sizeof(costBits));
+    return (static_cast<uint64_t>(costBits) << 32) | static_cast<uint32_t>(index);
+}
+
+ConcurrentNNLookup::Slot* ConcurrentNNLookup::findSlot(uint64_t key, bool insert) const
+{
+    //mix the key, neighbouring cells differ in few bits only
+    uint64_t hash = key;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    for(uint64_t i = 0; i <= mask; i++)
+    {
+        Slot &slot(slots[(hash + i) & mask]);
+        const uint64_t slotKey = slot.key;
+        if(slotKey == key)
+            return &slot;
+
+        if(slotKey != emptyKey)
+            continue;
+
+        if(!insert)
+            return NULL;
+
+        //claim the slot, or find out who was faster
+        const uint64_t prev = __sync_val_compare_and_swap(&slot.key, emptyKey, key);
+        if(prev == emptyKey || prev == key)
+            return &slot;
+    }
+
+    if(insert)
+        throw std::runtime_error("ConcurrentNNLookup: Error, table is full");
+
+    return NULL;
+}
+
+bool ConcurrentNNLookup::setNode(const base::Vector3d& position, const BinaryAngle& yaw, uint8_t driveModeNr, int index, double cost)
+{
+    Slot *slot = findSlot(getKey(position, yaw, driveModeNr), true);
+    const uint64_t value = packValue(index, cost);
+
+    uint64_t cur = slot->value;
+    while(value < cur)
+    {
+        const uint64_t prev = __sync_val_compare_and_swap(&slot->value, cur, value);
+        if(prev == cur)
+            return true;
+
+        cur = prev;
+    }
+
+    return false;
+}
+
+int ConcurrentNNLookup::getNodeWithinBounds(const base::Vector3d& position, const BinaryAngle& yaw, uint8_t driveModeNr) const
+{
+    const Slot *slot = findSlot(getKey(position, yaw, driveModeNr), false);
+    if(!slot)
+        return -1;
+
+    const uint64_t value = slot->value;
+    if(value == emptyValue)
+        return -1;
+
+    return static_cast<uint32_t>(value);
+}
+
+void ConcurrentNNLookup::clearIfSame(const base::Vector3d& position, const BinaryAngle& yaw, uint8_t driveModeNr, int index)
+{
+    Slot *slot = findSlot(getKey(position, yaw, driveModeNr), false);
+    if(!slot)
+        return;
+
+    //the key stays, so the slot is reused if the cell is set again
+    uint64_t cur = slot->value;
+    while(cur != emptyValue && static_cast<int>(static_cast<uint32_t>(cur)) == index)
+    {
+        const uint64_t prev = __sync_val_compare_and_swap(&slot->value, cur, emptyValue);
+        if(prev == cur)
+            return;
+
+        cur = prev;
+    }
+}
+
+bool ConcurrentNNLookup::setNode(const TreeNode& node)
+{
+    return setNode(node.getPosition(), node.getBinaryYaw(), node.getDriveModeNr(), node.getIndex(), node.getCost());
+}
+
+int ConcurrentNNLookup::getNodeWithinBounds(const TreeNode& node) const
+{
+    return getNodeWithinBounds(node.getPosition(), node.getBinaryYaw(), node.getDriveModeNr());
+}
+
+void ConcurrentNNLookup::clearIfSame(const TreeNode& node)
+{
+    clearIfSame(node.getPosition(), node.getBinaryYaw(), node.getDriveModeNr(), node.getIndex());
+}
+
+}
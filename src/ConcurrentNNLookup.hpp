@@ -0,0 +1,89 @@
+#ifndef CONCURRENTNNLOOKUP_HPP
+#define CONCURRENTNNLOOKUP_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "TreeNode.hpp"
+
+namespace vfh_star {
+
+/**
+ * Duplicate detection for nodes, that may be used by
+ * several threads at the same time.
+ *
+ * Like NNLookup, the poses are discretized into cells of
+ * resolutionXY x resolutionXY x resolutionTheta per drive mode.
+ * Every cell stores the index and the cost of one node. The cells
+ * live in an open addressing hash table of fixed capacity, which is
+ * only modified by compare and swap operations. If two nodes are set
+ * for the same cell, the cheaper one wins, on equal costs the one
+ * with the lower index.
+ *
+ * clear must not be called concurrently to any other method.
+ * */
+class ConcurrentNNLookup
+{
+public:
+    /**
+     * @param capacity maximum number of cells, that can be set
+     *                 until the next clear. The table uses twice
+     *                 this number of slots.
+     * */
+    ConcurrentNNLookup(double resolutionXY, double resolutionTheta, size_t capacity);
+
+    /**
+     * Sets the node for its cell, if there is no cheaper node
+     * in the cell. Returns true if the node was set.
+     * Throws if the table is full.
+     * */
+    bool setNode(const TreeNode &node);
+
+    /**
+     * Returns the index of the node in the cell of the given node,
+     * or -1 if the cell is empty
+     * */
+    int getNodeWithinBounds(const TreeNode &node) const;
+
+    /**
+     * Empties the cell of the node, if the node is set in it
+     * */
+    void clearIfSame(const TreeNode &node);
+
+    void clear();
+
+    bool setNode(const base::Vector3d &position, const BinaryAngle &yaw, uint8_t driveModeNr, int index, double cost);
+    int getNodeWithinBounds(const base::Vector3d &position, const BinaryAngle &yaw, uint8_t driveModeNr) const;
+    void clearIfSame(const base::Vector3d &position, const BinaryAngle &yaw, uint8_t driveModeNr, int index);
+
+private:
+    ///key and value of an empty slot
+    static const uint64_t emptyKey = 0;
+    static const uint64_t emptyValue = ~static_cast<uint64_t>(0);
+
+    struct Slot
+    {
+        volatile uint64_t key;
+        ///cost as float bits in the upper half, node index in the lower half
+        volatile uint64_t value;
+    };
+
+    uint64_t getKey(const base::Vector3d &position, const BinaryAngle &yaw, uint8_t driveModeNr) const;
+
+    /**
+     * Returns the slot of the key. If the key is not in the
+     * table and insert is true, a new slot is claimed for it,
+     * otherwise NULL is returned.
+     * */
+    Slot *findSlot(uint64_t key, bool insert) const;
+
+    static uint64_t packValue(int index, double cost);
+
+    double resolutionXY;
+    int angleCells;
+    uint64_t mask;
+    mutable std::vector<Slot> slots;
+};
+
+}
+
+#endif // CONCURRENTNNLOOKUP_HPP
@@ -0,0 +1,170 @@
+#include "ConfigurationSpace.hpp"
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace vfh_star {
+
+ConfigurationSpace::ConfigurationSpace() : gridWidth(0), gridHeight(0), yawBins(0), yawResolution(0), stencilRadius(0)
+{
+}
+
+void ConfigurationSpace::clear()
+{
+    collisionGrids.clear();
+    stencils.clear();
+    yawBins = 0;
+}
+
+void ConfigurationSpace::swap(ConfigurationSpace& other)
+{
+    std::swap(gridWidth, other.gridWidth);
+    std::swap(gridHeight, other.gridHeight);
+    std::swap(yawBins, other.yawBins);
+    std::swap(yawResolution, other.yawResolution);
+    std::swap(stencilRadius, other.stencilRadius);
+    stencils.swap(other.stencils);
+    collisionGrids.swap(other.collisionGrids);
+}
+
+bool ConfigurationSpace::isEmpty() const
+{
+    return collisionGrids.empty();
+}
+
+void ConfigurationSpace::compute(const ObstacleBitmap& obstacles, double scale, double length, double width, int yawBins)
+{
+    if(yawBins <= 0)
+        throw std::runtime_error("ConfigurationSpace::compute: Error, yawBins must be greater than zero");
+
+    gridWidth = obstacles.getWidth();
+    gridHeight = obstacles.getHeight();
+    this->yawBins = yawBins;
+    yawResolution = M_PI / yawBins;
+
+    collisionGrids.resize(yawBins);
+
+    //a yaw bin is used for all yaws within +- yawResolution / 2.0 of
+    //its center. We grow the footprint so that it contains the
+    //footprint rotated to any of these yaws
+    const double halfAngle = yawResolution / 2.0;
+    const double halfLength = length / 2.0;
+    const double halfWidth = width / 2.0;
+    const double halfLengthCells = (halfLength * cos(halfAngle) + halfWidth * sin(halfAngle)) / scale;
+    const double halfWidthCells = (halfWidth * cos(halfAngle) + halfLength * sin(halfAngle)) / scale;
+
+    stencils.resize(yawBins);
+    stencilRadius = 0;
+    for(int i = 0; i < yawBins; i++)
+    {
+        computeStencil(stencils[i], i * yawResolution, halfLengthCells, halfWidthCells);
+        for(std::vector<Span>::const_iterator it = stencils[i].begin(); it != stencils[i].end(); it++)
+            stencilRadius = std::max(stencilRadius, std::max<int>(abs(it->y), std::max<int>(-it->xStart, it->xEnd)));
+
+        collisionGrids[i].resize(gridWidth, gridHeight);
+    }
+
+    dilate(obstacles, 0, 0, gridWidth - 1, gridHeight - 1);
+}
+
+void ConfigurationSpace::update(const ObstacleBitmap& obstacles, int minX, int minY, int maxX, int maxY)
+{
+    if(isEmpty())
+        return;
+
+    if(obstacles.getWidth() != gridWidth || obstacles.getHeight() != gridHeight)
+        throw std::runtime_error("ConfigurationSpace::update: Error, the size of the grid changed");
+
+    //every cell whose stencil reaches into the area may have changed
+    dilate(obstacles, std::max(0, minX - stencilRadius), std::max(0, minY - stencilRadius),
+           std::min(gridWidth - 1, maxX + stencilRadius), std::min(gridHeight - 1, maxY + stencilRadius));
+}
+
+void ConfigurationSpace::shift(int dx, int dy)
+{
+    for(std::vector<ObstacleBitmap>::iterator it = collisionGrids.begin(); it != collisionGrids.end(); it++)
+        it->shift(dx, dy);
+}
+
+void ConfigurationSpace::computeStencil(std::vector<Span> &stencil, double yaw, double halfLength, double halfWidth) const
+{
+    const double dirX = cos(yaw);
+    const double dirY = sin(yaw);
+    const double absX = fabs(dirX);
+    const double absY = fabs(dirY);
+
+    //The robot may be anywhere within its cell, and the obstacle covers
+    //its whole cell. So the offsets of the points of the obstacle cell
+    //relative to the robot cover a square of two cells around the cell
+    //offset. The offset is part of the stencil, if this square overlaps
+    //the footprint, which is tested on the separating axes of both.
+    const double boundX = 1.0 + halfLength * absX + halfWidth * absY;
+    const double boundY = 1.0 + halfLength * absY + halfWidth * absX;
+    const double boundHeading = halfLength + absX + absY;
+    const double boundSide = halfWidth + absX + absY;
+
+    stencil.clear();
+    const int maxX = ceil(boundX);
+    const int maxY = ceil(boundY);
+    for(int y = -maxY; y <= maxY; y++)
+    {
+        Span span;
+        span.y = y;
+        span.xStart = maxX + 1;
+        span.xEnd = -maxX - 1;
+        for(int x = -maxX; x <= maxX; x++)
+        {
+            if(fabs(x) >= boundX || fabs(y) >= boundY
+                || fabs(x * dirX + y * dirY) >= boundHeading
+                || fabs(-x * dirY + y * dirX) >= boundSide)
+                continue;
+
+            span.xStart = std::min<int>(span.xStart, x);
+            span.xEnd = std::max<int>(span.xEnd, x);
+        }
+        if(span.xStart <= span.xEnd)
+            stencil.push_back(span);
+    }
+}
+
+void ConfigurationSpace::dilate(const ObstacleBitmap& obstacles, int x0, int y0, int x1, int y1)
+{
+    for(int i = 0; i < yawBins; i++)
+    {
+        const std::vector<Span> &stencil(stencils[i]);
+        ObstacleBitmap &grid(collisionGrids[i]);
+        for(int y = y0; y <= y1; y++)
+        {
+            for(int x = x0; x <= x1; x++)
+            {
+                //go safe, everything outside of the grid is an obstacle
+                bool colliding = false;
+                for(std::vector<Span>::const_iterator it = stencil.begin(); it != stencil.end() && !colliding; it++)
+                    colliding = obstacles.hasObstacleInSpan(y + it->y, x + it->xStart, x + it->xEnd);
+
+                grid.setObstacle(x, y, colliding);
+            }
+        }
+    }
+}
+
+int ConfigurationSpace::getYawBin(double yaw) const
+{
+    int bin = floor(yaw / yawResolution + 0.5);
+    bin %= yawBins;
+    if(bin < 0)
+        bin += yawBins;
+
+    return bin;
+}
+
+bool ConfigurationSpace::isColliding(int x, int y, double yaw) const
+{
+    if(x < 0 || y < 0 || x >= gridWidth || y >= gridHeight)
+        return true;
+
+    return collisionGrids[getYawBin(yaw)].isObstacleUnchecked(x, y);
+}
+
+}
@@ -0,0 +1,94 @@
+#ifndef CONFIGURATIONSPACE_HPP
+#define CONFIGURATIONSPACE_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "ObstacleBitmap.hpp"
+
+namespace vfh_star {
+
+/**
+ * Precomputed configuration space of a rectangular robot.
+ *
+ * For every yaw bin the obstacle grid is dilated by the rotated
+ * footprint of the robot. Afterwards a pose is in collision, if the
+ * bit of its cell in the grid of its yaw bin is set.
+ *
+ * The footprint of a yaw bin is rasterized as a stencil of all cell
+ * offsets at which an obstacle cell may touch the robot, for any yaw
+ * of the bin and any position of the robot within its cell. As the
+ * footprint is convex, the stencil is stored as one span per row,
+ * which is tested against the ObstacleBitmap word wise. The footprint
+ * is symmetric, therefore the yaw bins only cover [0, PI).
+ * */
+class ConfigurationSpace
+{
+public:
+    ConfigurationSpace();
+
+    /**
+     * Computes the configuration space.
+     *
+     * @param scale size of a cell in meters
+     * @param length extend of the footprint along the heading in meters
+     * @param width extend of the footprint perpendicular to the heading in meters
+     * @param yawBins number of yaw bins over [0, PI)
+     *
+     * Everything outside of the grid is considered an obstacle.
+     * */
+    void compute(const ObstacleBitmap &obstacles, double scale, double length, double width, int yawBins);
+
+    /**
+     * Recomputes the collisions that are affected by changed obstacles
+     * within the given area (both corners inclusive). The size of the
+     * obstacle bitmap must not have changed since the last compute.
+     * */
+    void update(const ObstacleBitmap &obstacles, int minX, int minY, int maxX, int maxY);
+
+    /**
+     * Moves the content of the configuration space, so that afterwards
+     * the cell (x, y) contains what was in the cell (x + dx, y + dy)
+     * before. Cells without source are free and need to be updated.
+     * */
+    void shift(int dx, int dy);
+
+    /**
+     * Returns true if the robot collides, if it is located
+     * in cell x, y with the given yaw.
+     * */
+    bool isColliding(int x, int y, double yaw) const;
+
+    bool isEmpty() const;
+
+    void clear();
+
+    void swap(ConfigurationSpace &other);
+
+private:
+    struct Span
+    {
+        int16_t y;
+        int16_t xStart;
+        int16_t xEnd;
+    };
+
+    void computeStencil(std::vector<Span> &stencil, double yaw, double halfLength, double halfWidth) const;
+    void dilate(const ObstacleBitmap &obstacles, int x0, int y0, int x1, int y1);
+    int getYawBin(double yaw) const;
+
+    int gridWidth;
+    int gridHeight;
+    int yawBins;
+    double yawResolution;
+    ///maximum offset of a stencil cell in x or y
+    int stencilRadius;
+
+    ///footprint stencil per yaw bin
+    std::vector<std::vector<Span> > stencils;
+    ///collision grid per yaw bin
+    std::vector<ObstacleBitmap> collisionGrids;
+};
+
+}
+
+#endif // CONFIGURATIONSPACE_HPP
@@ -0,0 +1,153 @@
+#include "DirectionSampleTable.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace vfh_star {
+
+DirectionSampleTable::DirectionSampleTable() : bins(0), wordsPerMask(0), binWidth(0)
+{
+}
+
+bool DirectionSampleTable::isEmpty() const
+{
+    return candidateMasks.empty();
+}
+
+void DirectionSampleTable::clear()
+{
+    candidateMasks.clear();
+    areaMasks.clear();
+    bins = 0;
+}
+
+int DirectionSampleTable::getBin(const BinaryAngle& angle) const
+{
+    //shift by half a bin, so that the bins are centered on their angles
+    return (angle + BinaryAngle::fromRaw((static_cast<uint64_t>(1) << 31) / bins)).getBin(bins);
+}
+
+void DirectionSampleTable::clearMask(DirectionSampleTable::BinMask& mask) const
+{
+    mask.assign(wordsPerMask, 0);
+}
+
+void DirectionSampleTable::compile(const std::vector< AngleSampleConf >& sampleAreas, int bins, double densityScale)
+{
+    if(bins <= 0)
+        throw std::runtime_error("DirectionSampleTable::compile: Error, bins must be greater than zero");
+
+    this->bins = bins;
+    wordsPerMask = (bins + 63) / 64;
+    binWidth = 2 * M_PI / bins;
+
+    candidateMasks.assign(bins * wordsPerMask, 0);
+    areaMasks.assign(bins * wordsPerMask, 0);
+
+    for(int curBin = 0; curBin < bins; curBin++)
+    {
+        BinMask candidates(wordsPerMask, 0);
+        BinMask area(wordsPerMask, 0);
+
+        for(std::vector<AngleSampleConf>::const_iterator it = sampleAreas.begin(); it != sampleAreas.end(); it++)
+        {
+            const bool fullCircle = it->intervalWidth <= 0 || it->intervalWidth >= 2 * M_PI;
+            const double width = fullCircle ? 2 * M_PI : it->intervalWidth;
+            const int startBin = curBin + floor(it->intervalStart / binWidth + 0.5);
+            const int widthBins = fullCircle ? bins - 1 : floor(width / binWidth + 0.5);
+
+            const int nominalCount = std::max(1, static_cast<int>(floor(it->angularSamplingNominalCount * densityScale + 0.5)));
+            double step = width / nominalCount;
+            if(step < it->angularSamplingMin / densityScale)
+                step = it->angularSamplingMin / densityScale;
+            else if(step > it->angularSamplingMax / densityScale)
+                step = it->angularSamplingMax / densityScale;
+            const int stepBins = std::max(1, static_cast<int>(floor(step / binWidth + 0.5)));
+
+            for(int i = 0; i <= widthBins; i++)
+            {
+                const int bin = ((startBin + i) % bins + bins) % bins;
+                setBin(area, bin);
+                if(i % stepBins == 0 || (!fullCircle && i == widthBins))
+                    setBin(candidates, bin);
+            }
+        }
+
+        //the current direction is always a candidate, if it is inside of a sample area
+        if(isBinSet(area, curBin))
+            setBin(candidates, curBin);
+
+        std::copy(candidates.begin(), candidates.end(), candidateMasks.begin() + curBin * wordsPerMask);
+        std::copy(area.begin(), area.end(), areaMasks.begin() + curBin * wordsPerMask);
+    }
+}
+
+void DirectionSampleTable::sample(const BinaryAngle& curDir, const DirectionSampleTable::BinMask& drivable, std::vector< BinaryAngle >& result) const
+{
+    const int curBin = getBin(curDir);
+    const uint64_t *candidates = &candidateMasks[curBin * wordsPerMask];
+    const uint64_t *area = &areaMasks[curBin * wordsPerMask];
+
+    for(int w = 0; w < wordsPerMask; w++)
+    {
+        uint64_t bits = candidates[w] & drivable[w];
+        while(bits)
+        {
+            const int bin = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            if(bin == curBin)
+                result.push_back(curDir);
+            else
+                result.push_back(BinaryAngle::fromRaw((static_cast<uint64_t>(bin) << 32) / bins));
+        }
+    }
+
+    //look for drivable areas that were missed by the candidates,
+    //e.g. narrow gaps between two candidates. We start the search
+    //at a bin that is not reachable, so that no area wraps around
+    int start = -1;
+    for(int bin = 0; bin < bins; bin++)
+    {
+        if(!(((area[bin >> 6] >> (bin & 63)) & 1) && isBinSet(drivable, bin)))
+        {
+            start = bin;
+            break;
+        }
+    }
+
+    //everything is reachable, so the candidates cover it
+    if(start < 0)
+        return;
+
+    int runStart = -1;
+    bool covered = false;
+    for(int i = 1; i <= bins; i++)
+    {
+        const int bin = (start + i) % bins;
+        const bool reachable = ((area[bin >> 6] >> (bin & 63)) & 1) && isBinSet(drivable, bin);
+        if(reachable)
+        {
+            if(runStart < 0)
+            {
+                runStart = i;
+                covered = false;
+            }
+            if((candidates[bin >> 6] >> (bin & 63)) & 1)
+                covered = true;
+        }
+        else if(runStart >= 0)
+        {
+            if(!covered)
+            {
+                //the run covers the bins runStart to i - 1, which
+                //are centered at their angles
+                const double middle = start + runStart + (i - runStart - 1) / 2.0;
+                result.push_back(BinaryAngle::fromRad(middle * binWidth));
+            }
+            runStart = -1;
+        }
+    }
+}
+
+}
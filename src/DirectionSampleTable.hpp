@@ -0,0 +1,89 @@
+#ifndef DIRECTIONSAMPLETABLE_HPP
+#define DIRECTIONSAMPLETABLE_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "BinaryAngle.hpp"
+#include "Types.h"
+
+namespace vfh_star {
+
+/**
+ * The sampling policies (AngleSampleConf) compiled into lookup
+ * tables over a fixed number of direction bins.
+ *
+ * For every bin of the current direction, the table contains a
+ * bitmask of candidate bins and a bitmask of all bins covered by
+ * the sample areas. Sampling is then an AND of the candidate mask
+ * with the mask of drivable bins.
+ * */
+class DirectionSampleTable
+{
+public:
+    typedef std::vector<uint64_t> BinMask;
+
+    DirectionSampleTable();
+
+    /**
+     * Compiles the given sampling policies for the given number of bins.
+     * The angular sampling steps of the policies are divided by densityScale.
+     * */
+    void compile(const std::vector<AngleSampleConf> &sampleAreas, int bins, double densityScale = 1.0);
+
+    bool isEmpty() const;
+
+    void clear();
+
+    int getBinCount() const
+    {
+        return bins;
+    }
+
+    double getBinWidth() const
+    {
+        return binWidth;
+    }
+
+    /**
+     * Returns the bin, whose center is closest to the angle
+     * */
+    int getBin(const BinaryAngle &angle) const;
+
+    /**
+     * Resizes the mask to the number of bins of
+     * this table and clears all bits
+     * */
+    void clearMask(BinMask &mask) const;
+
+    static void setBin(BinMask &mask, int bin)
+    {
+        mask[bin >> 6] |= static_cast<uint64_t>(1) << (bin & 63);
+    }
+
+    static bool isBinSet(const BinMask &mask, int bin)
+    {
+        return (mask[bin >> 6] >> (bin & 63)) & 1;
+    }
+
+    /**
+     * Appends the sample directions for the given current direction
+     * to result. Only bins set in drivable are returned. Drivable areas
+     * within the sample areas that do not contain a candidate bin, are
+     * sampled at their middle.
+     * */
+    void sample(const BinaryAngle &curDir, const BinMask &drivable, std::vector<BinaryAngle> &result) const;
+
+private:
+    int bins;
+    int wordsPerMask;
+    double binWidth;
+
+    ///candidate bins, wordsPerMask words per current direction bin
+    std::vector<uint64_t> candidateMasks;
+    ///bins covered by the sample areas, wordsPerMask words per current direction bin
+    std::vector<uint64_t> areaMasks;
+};
+
+}
+
+#endif // DIRECTIONSAMPLETABLE_HPP
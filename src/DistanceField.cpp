@@ -0,0 +1,178 @@
+#include "DistanceField.hpp"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace vfh_star {
+
+DistanceField::DistanceField() : width(0), height(0)
+{
+}
+
+bool DistanceField::isEmpty() const
+{
+    return distances.empty();
+}
+
+void DistanceField::swap(DistanceField& other)
+{
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    distances.swap(other.distances);
+}
+
+void DistanceField::clear()
+{
+    distances.clear();
+    width = 0;
+    height = 0;
+}
+
+void DistanceField::transform1D(const std::vector< float >& f, std::vector< float >& d, int n,
+                                std::vector< int >& v, std::vector< float >& z)
+{
+    //lower envelope of the parabolas rooted at all finite entries of f.
+    //f[0] is always finite, as it is the border of the grid
+    const float inf = std::numeric_limits<float>::infinity();
+    int k = 0;
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] = inf;
+    for(int q = 1; q < n; q++)
+    {
+        if(f[q] == inf)
+            continue;
+
+        double s;
+        while(true)
+        {
+            const int p = v[k];
+            s = ((f[q] + static_cast<double>(q) * q) - (f[p] + static_cast<double>(p) * p)) / (2.0 * q - 2.0 * p);
+            if(s > z[k] || k == 0)
+                break;
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = inf;
+    }
+
+    k = 0;
+    for(int q = 0; q < n; q++)
+    {
+        while(z[k + 1] < q)
+            k++;
+        const float diff = q - v[k];
+        d[q] = diff * diff + f[v[k]];
+    }
+}
+
+void DistanceField::compute(const ObstacleBitmap& obstacles, double scale, double maxDistance)
+{
+    width = obstacles.getWidth();
+    height = obstacles.getHeight();
+    distances.resize(width * height);
+
+    computeArea(obstacles, scale, maxDistance, 0, 0, width - 1, height - 1);
+}
+
+void DistanceField::update(const ObstacleBitmap& obstacles, double scale, double maxDistance, int minX, int minY, int maxX, int maxY)
+{
+    if(obstacles.getWidth() != width || obstacles.getHeight() != height)
+        throw std::runtime_error("DistanceField::update: Error, size of the obstacle bitmap changed");
+
+    //distances are capped, so only cells within maxDistance
+    //of a changed cell can change
+    const int band = ceil(maxDistance / scale) + 1;
+    minX = std::max(0, minX - band);
+    minY = std::max(0, minY - band);
+    maxX = std::min(width - 1, maxX + band);
+    maxY = std::min(height - 1, maxY + band);
+    if(maxX < minX || maxY < minY)
+        return;
+
+    computeArea(obstacles, scale, maxDistance, minX, minY, maxX, maxY);
+}
+
+void DistanceField::computeArea(const ObstacleBitmap& obstacles, double scale, double maxDistance, int minX, int minY, int maxX, int maxY)
+{
+    //the transform is done on the area plus a band around it, so that
+    //all obstacles closer than maxDistance to the area are seen. The
+    //artificial border of the extended area is further away than maxDistance
+    const int band = ceil(maxDistance / scale) + 1;
+    const int areaMinX = std::max(0, minX - band);
+    const int areaMinY = std::max(0, minY - band);
+    const int areaWidth = std::min(width - 1, maxX + band) - areaMinX + 1;
+    const int areaHeight = std::min(height - 1, maxY + band) - areaMinY + 1;
+
+    const float inf = std::numeric_limits<float>::infinity();
+    const int maxSize = std::max(areaWidth, areaHeight) + 2;
+    std::vector<float> f(maxSize);
+    std::vector<float> d(maxSize);
+    std::vector<int> v(maxSize);
+    std::vector<float> z(maxSize + 1);
+    std::vector<float> columnDistances(areaWidth * areaHeight);
+
+    //squared distance in cells along the columns. The area
+    //is surrounded by a border of obstacles at -1 and areaHeight
+    for(int x = 0; x < areaWidth; x++)
+    {
+        f[0] = 0;
+        f[areaHeight + 1] = 0;
+        for(int y = 0; y < areaHeight; y++)
+            f[y + 1] = obstacles.isObstacle(areaMinX + x, areaMinY + y) ? 0 : inf;
+
+        transform1D(f, d, areaHeight + 2, v, z);
+
+        for(int y = 0; y < areaHeight; y++)
+            columnDistances[y * areaWidth + x] = d[y + 1];
+    }
+
+    //squared distance in cells along the rows
+    const float maxDistanceCells = maxDistance / scale;
+    for(int y = minY; y <= maxY; y++)
+    {
+        const int ay = y - areaMinY;
+        f[0] = 0;
+        f[areaWidth + 1] = 0;
+        for(int x = 0; x < areaWidth; x++)
+            f[x + 1] = columnDistances[ay * areaWidth + x];
+
+        transform1D(f, d, areaWidth + 2, v, z);
+
+        for(int x = minX; x <= maxX; x++)
+            distances[y * width + x] = std::min(sqrtf(d[x - areaMinX + 1]), maxDistanceCells) * scale;
+    }
+}
+
+void DistanceField::shift(int dx, int dy)
+{
+    if(abs(dx) >= width || abs(dy) >= height)
+    {
+        std::fill(distances.begin(), distances.end(), 0);
+        return;
+    }
+
+    //iterate in the direction that does not overwrite unread sources
+    const int startY = dy > 0 ? 0 : height - 1;
+    const int stepY = dy > 0 ? 1 : -1;
+    const int startX = dx > 0 ? 0 : width - 1;
+    const int stepX = dx > 0 ? 1 : -1;
+    for(int y = startY; y >= 0 && y < height; y += stepY)
+    {
+        const int sy = y + dy;
+        for(int x = startX; x >= 0 && x < width; x += stepX)
+        {
+            const int sx = x + dx;
+            if(sx < 0 || sy < 0 || sx >= width || sy >= height)
+                distances[y * width + x] = 0;
+            else
+                distances[y * width + x] = distances[sy * width + sx];
+        }
+    }
+}
+
+}
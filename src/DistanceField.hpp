@@ -0,0 +1,77 @@
+#ifndef DISTANCEFIELD_HPP
+#define DISTANCEFIELD_HPP
+
+#include <vector>
+#include "ObstacleBitmap.hpp"
+
+namespace vfh_star {
+
+/**
+ * Euclidean distance from every cell to the closest obstacle,
+ * computed with the separable exact distance transform of
+ * Felzenszwalb and Huttenlocher.
+ *
+ * Everything outside of the grid is considered an obstacle.
+ * Distances are capped at a maximum distance.
+ * */
+class DistanceField
+{
+public:
+    DistanceField();
+
+    /**
+     * Computes the distance field of the given obstacles.
+     * @param scale size of a cell in meters
+     * @param maxDistance distances are capped at this value in meters
+     * */
+    void compute(const ObstacleBitmap &obstacles, double scale, double maxDistance);
+
+    /**
+     * Recomputes the distances that are affected by changed obstacles
+     * within the given area (both corners inclusive). The size of the
+     * obstacle bitmap must not have changed since the last compute.
+     * */
+    void update(const ObstacleBitmap &obstacles, double scale, double maxDistance, int minX, int minY, int maxX, int maxY);
+
+    /**
+     * Moves the content of the field, so that afterwards the cell
+     * (x, y) contains what was in the cell (x + dx, y + dy) before.
+     * Cells without source are set to zero and need to be updated.
+     * */
+    void shift(int dx, int dy);
+
+    bool isEmpty() const;
+
+    void clear();
+
+    void swap(DistanceField &other);
+
+    /**
+     * Returns the distance of the cell to the closest obstacle in meters.
+     * Returns zero for cells outside of the grid.
+     * */
+    float getDistance(int x, int y) const
+    {
+        if(x < 0 || y < 0 || x >= width || y >= height)
+            return 0;
+
+        return distances[y * width + x];
+    }
+
+private:
+    /**
+     * Computes the distances of the cells within the given area
+     * */
+    void computeArea(const ObstacleBitmap &obstacles, double scale, double maxDistance, int minX, int minY, int maxX, int maxY);
+
+    static void transform1D(const std::vector<float> &f, std::vector<float> &d, int n,
+                            std::vector<int> &v, std::vector<float> &z);
+
+    int width;
+    int height;
+    std::vector<float> distances;
+};
+
+}
+
+#endif // DISTANCEFIELD_HPP
@@ -57,6 +57,11 @@ public:
     
     /**
      * Returns the cost of driving from the parentNode to the projected position using this drive mode;
+     *
+     * With macro steps or a resolution schedule, steps can be longer
+     * than the stepDistance of the search. Costs that are charged per
+     * step should then be scaled by the step length, so that long steps
+     * are not cheaper than the equivalent normal steps.
      * */
     virtual double getCostForNode(const ProjectedPose& projection,const base::Angle &direction, const TreeNode& parentNode) const = 0;
     
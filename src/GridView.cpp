@@ -0,0 +1,59 @@
+#include "GridView.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <envire/maps/TraversabilityGrid.hpp>
+
+namespace vfh_star {
+
+GridView::GridView() : data(0), width(0), height(0), stride(0), scale(0), offsetX(0), offsetY(0),
+    obstacleClasses(256, true)
+{
+}
+
+GridView::GridView(const uint8_t* data, int width, int height, int stride, double scale, double offsetX, double offsetY) :
+    data(data), width(width), height(height), stride(stride), scale(scale), offsetX(offsetX), offsetY(offsetY),
+    obstacleClasses(256, true)
+{
+    if(!data || width <= 0 || height <= 0 || stride < width || scale <= 0)
+        throw std::runtime_error("GridView: Error, invalid map memory or geometry");
+}
+
+void GridView::swap(GridView& other)
+{
+    std::swap(data, other.data);
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    std::swap(stride, other.stride);
+    std::swap(scale, other.scale);
+    std::swap(offsetX, other.offsetX);
+    std::swap(offsetY, other.offsetY);
+    obstacleClasses.swap(other.obstacleClasses);
+}
+
+GridView GridView::fromTraversabilityGrid(const envire::TraversabilityGrid& grid)
+{
+    if(grid.getScaleX() != grid.getScaleY())
+        throw std::runtime_error("GridView::fromTraversabilityGrid: Error, only square cells are supported");
+
+    //the multi array is row major, y is the outer index
+    const envire::TraversabilityGrid::ArrayType &gridData = grid.getGridData();
+    GridView view(gridData.data(), grid.getCellSizeX(), grid.getCellSizeY(), gridData.strides()[0],
+                  grid.getScaleX(), grid.getOffsetX(), grid.getOffsetY());
+
+    //go safe, unknown classes are obstacles
+    const std::vector<envire::TraversabilityClass> &trClasses(grid.getTraversabilityClasses());
+    for(size_t i = 0; i < trClasses.size() && i < view.obstacleClasses.size(); i++)
+        view.obstacleClasses[i] = !trClasses[i].isTraversable();
+
+    return view;
+}
+
+bool GridView::toGrid(double x, double y, int& cellX, int& cellY) const
+{
+    cellX = floor((x - offsetX) / scale);
+    cellY = floor((y - offsetY) / scale);
+    return cellX >= 0 && cellY >= 0 && cellX < width && cellY < height;
+}
+
+}
@@ -0,0 +1,136 @@
+#ifndef GRIDVIEW_HPP
+#define GRIDVIEW_HPP
+
+#include <stdint.h>
+#include <vector>
+
+namespace envire {
+    class TraversabilityGrid;
+}
+
+namespace vfh_star {
+
+/**
+ * Read only view of a traversability map in externally owned memory.
+ *
+ * The map is a row major array of class ids, one byte per cell.
+ * Rows are stride bytes apart, so views into larger buffers are
+ * possible. The view does not copy the cells, the memory must stay
+ * valid and unchanged as long as the view is in use.
+ *
+ * Which classes are obstacles is given by a lookup table. By default
+ * every class is an obstacle.
+ * */
+class GridView
+{
+public:
+    GridView();
+
+    /**
+     * @param data class id of the cell (0, 0)
+     * @param width number of cells in x
+     * @param height number of cells in y
+     * @param stride distance between two rows in bytes
+     * @param scale size of a cell in meters
+     * @param offsetX position of the lower left corner of the map in meters
+     * @param offsetY position of the lower left corner of the map in meters
+     * */
+    GridView(const uint8_t *data, int width, int height, int stride,
+             double scale, double offsetX, double offsetY);
+
+    /**
+     * Creates a view of the given envire grid, including
+     * its traversability classes. The grid must outlive the view.
+     * */
+    static GridView fromTraversabilityGrid(const envire::TraversabilityGrid &grid);
+
+    void swap(GridView &other);
+
+    void setObstacleClass(uint8_t classId, bool obstacle)
+    {
+        obstacleClasses[classId] = obstacle;
+    }
+
+    bool isObstacleClass(uint8_t classId) const
+    {
+        return obstacleClasses[classId];
+    }
+
+    /**
+     * Lookup table from class id to obstacle, always 256 entries
+     * */
+    const std::vector<bool> &getObstacleClasses() const
+    {
+        return obstacleClasses;
+    }
+
+    bool isValid() const
+    {
+        return data != 0;
+    }
+
+    uint8_t getClass(int x, int y) const
+    {
+        return data[y * stride + x];
+    }
+
+    bool isObstacle(int x, int y) const
+    {
+        return obstacleClasses[getClass(x, y)];
+    }
+
+    /**
+     * Converts the position into cell coordinates.
+     * Returns false if the position is outside of the map.
+     * */
+    bool toGrid(double x, double y, int &cellX, int &cellY) const;
+
+    const uint8_t *getData() const
+    {
+        return data;
+    }
+
+    int getWidth() const
+    {
+        return width;
+    }
+
+    int getHeight() const
+    {
+        return height;
+    }
+
+    int getStride() const
+    {
+        return stride;
+    }
+
+    double getScale() const
+    {
+        return scale;
+    }
+
+    double getOffsetX() const
+    {
+        return offsetX;
+    }
+
+    double getOffsetY() const
+    {
+        return offsetY;
+    }
+
+private:
+    const uint8_t *data;
+    int width;
+    int height;
+    int stride;
+    double scale;
+    double offsetX;
+    double offsetY;
+    std::vector<bool> obstacleClasses;
+};
+
+}
+
+#endif // GRIDVIEW_HPP
@@ -0,0 +1,120 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <cassert>
+
+namespace vfh_star {
+
+/**
+ * Polar obstacle histogram with a size given at runtime.
+ *
+ * Magnitudes are summed up as doubles, the bin
+ * indices are wrapped around on every add.
+ * */
+class DynamicHistogram
+{
+public:
+    DynamicHistogram(int size, double lowThreshold) : bins(size, 0.0), lowThreshold(lowThreshold)
+    {
+    }
+
+    int getSize() const
+    {
+        return bins.size();
+    }
+
+    /**
+     * Adds the magnitude to the bins start to end (both inclusive).
+     * The range may exceed the histogram by less than one turn.
+     * */
+    void add(int start, int end, double magnitude)
+    {
+        const int size = bins.size();
+        for(int a = start; a <= end; a++)
+        {
+            int ac = a;
+            if(ac < 0)
+                ac += size;
+
+            if(ac >= size)
+                ac -= size;
+
+            bins[ac] += magnitude;
+        }
+    }
+
+    /**
+     * Bins with a magnitude up to lowThreshold are drivable
+     * */
+    void getBinary(std::vector<bool> &binary) const
+    {
+        binary.resize(bins.size());
+        for(size_t i = 0; i < bins.size(); i++)
+            binary[i] = bins[i] <= lowThreshold;
+    }
+
+private:
+    std::vector<double> bins;
+    double lowThreshold;
+};
+
+/**
+ * Polar obstacle histogram with Size bins and fixed point magnitudes.
+ *
+ * The magnitudes are stored in 16 bit, lowThreshold corresponds to
+ * thresholdUnits. Bins saturate, which does not change the result, as
+ * only the comparison against lowThreshold matters.
+ *
+ * The bins are stored three times in a row, so that ranges exceeding
+ * the histogram by less than one turn need no wrap around on add.
+ * The three copies are summed up in getBinary.
+ * */
+template <int Size>
+class FixedHistogram
+{
+public:
+    static const uint32_t thresholdUnits = 16384;
+
+    FixedHistogram(int size, double lowThreshold) : unitsPerMagnitude(thresholdUnits / lowThreshold)
+    {
+        assert(size == Size && lowThreshold > 0);
+        (void) size;
+        for(int i = 0; i < 3 * Size; i++)
+            bins[i] = 0;
+    }
+
+    int getSize() const
+    {
+        return Size;
+    }
+
+    void add(int start, int end, double magnitude)
+    {
+        assert(start >= -Size && end < 2 * Size);
+
+        const double units = magnitude * unitsPerMagnitude + 0.5;
+        const uint32_t m = units < 0xffff ? static_cast<uint32_t>(units) : 0xffff;
+        for(int a = start + Size; a <= end + Size; a++)
+        {
+            const uint32_t v = bins[a] + m;
+            bins[a] = v < 0xffff ? v : 0xffff;
+        }
+    }
+
+    void getBinary(std::vector<bool> &binary) const
+    {
+        binary.resize(Size);
+        for(int i = 0; i < Size; i++)
+            binary[i] = static_cast<uint32_t>(bins[i]) + bins[i + Size] + bins[i + 2 * Size] <= thresholdUnits;
+    }
+
+private:
+    double unitsPerMagnitude;
+    uint16_t bins[3 * Size];
+};
+
+}
+
+#endif // HISTOGRAM_HPP
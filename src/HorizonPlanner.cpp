@@ -1,4 +1,5 @@
 #include "HorizonPlanner.hpp"
+#include "Trace.hpp"
 #include <Eigen/Core>
 #include <map>
 #include <iostream>
@@ -33,13 +34,14 @@ std::vector< base::Trajectory > HorizonPlanner::getTrajectories(const base::Pose
 
 const TreeNode* HorizonPlanner::computePath(base::Pose const& start, const base::Angle &mainHeading_i, double horizon, const Eigen::Affine3d &body2Trajectory)
 {    
+    TraceSpan span("computePath");
     mainHeading_w = mainHeading_i;
     horizonDistance = horizon;
 
     //convert to tree frame
     const Affine3d world2Tree(getTreeToWorld().inverse());
     Vector3d startPos_tree = world2Tree * start.position;
-    mainHeading = mainHeading_i + base::Angle::fromRad(base::Pose(world2Tree).getYaw());
+    mainHeading = BinaryAngle::fromAngle(mainHeading_i) + BinaryAngle::fromRad(base::Pose(world2Tree).getYaw());
     
     //set z to 0.05 this is a hack for the visualization, 
     //so that the searchtree will allways be displayed above the traversability map
@@ -16,7 +16,7 @@ class HorizonPlanner : public TreeSearch
         virtual ~HorizonPlanner();
 
         std::vector<base::Trajectory> getTrajectories(const base::Pose& start, const base::Angle& mainHeading, double horizon, const Eigen::Affine3d& body2Trajectory = Eigen::Affine3d::Identity());
-        const TreeNode* computePath(const base::Pose& start, const base::Angle& mainHeading, double horizon, const Eigen::Affine3d& body2Trajectory = Eigen::Affine3d::Identity());
+        virtual const TreeNode* computePath(const base::Pose& start, const base::Angle& mainHeading, double horizon, const Eigen::Affine3d& body2Trajectory = Eigen::Affine3d::Identity());
         
         const base::Vector3d getHorizonOrigin() const;
 
@@ -25,7 +25,8 @@ class HorizonPlanner : public TreeSearch
         HorizonPlannerDebugData getDebugData() const;
         
     protected:
-        base::Angle mainHeading;
+        ///target heading in tree frame
+        BinaryAngle mainHeading;
         //start pose in world coordinates
         base::Pose startPose_w;
         //target heading in world frame
@@ -0,0 +1,76 @@
+#include "MapPreprocessor.hpp"
+
+namespace vfh_star {
+
+MapPreprocessor::MapPreprocessor() : stop(false), busy(false), hasPending(false)
+{
+    worker = boost::thread(&MapPreprocessor::run, this);
+}
+
+MapPreprocessor::~MapPreprocessor()
+{
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        stop = true;
+    }
+    condition.notify_all();
+    worker.join();
+}
+
+void MapPreprocessor::submit(const GridView& view, const VFHConf& conf)
+{
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        pendingView = view;
+        pendingConf = conf;
+        hasPending = true;
+    }
+    condition.notify_all();
+}
+
+boost::shared_ptr<VFH> MapPreprocessor::takeResult()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    boost::shared_ptr<VFH> ret;
+    ret.swap(result);
+    return ret;
+}
+
+void MapPreprocessor::waitIdle()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    while(hasPending || busy)
+        condition.wait(lock);
+}
+
+void MapPreprocessor::run()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    while(true)
+    {
+        while(!stop && !hasPending)
+            condition.wait(lock);
+
+        if(stop)
+            return;
+
+        const GridView view(pendingView);
+        const VFHConf conf(pendingConf);
+        hasPending = false;
+        busy = true;
+
+        //the expensive part runs without the lock, so that the
+        //planner can take results and submit new maps meanwhile
+        lock.unlock();
+        boost::shared_ptr<VFH> next(new VFH());
+        next->setConfig(conf);
+        next->setNewGridView(view);
+        lock.lock();
+
+        result = next;
+        busy = false;
+        condition.notify_all();
+    }
+}
+
+}
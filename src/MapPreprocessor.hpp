@@ -0,0 +1,69 @@
+#ifndef MAPPREPROCESSOR_HPP
+#define MAPPREPROCESSOR_HPP
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/shared_ptr.hpp>
+#include "VFH.h"
+
+namespace vfh_star {
+
+/**
+ * Worker thread, that computes the derived maps of VFH
+ * (obstacle bitmap, configuration space, distance field etc.)
+ * for new maps, while the planner keeps using the current ones.
+ *
+ * Maps are given to submit. If a new map is submitted before the
+ * worker started on the previous one, the previous one is dropped.
+ * The finished result is taken by the planning thread between two
+ * plans, see VFHStar::takePreprocessedMap.
+ * */
+class MapPreprocessor
+{
+public:
+    MapPreprocessor();
+
+    /**
+     * Stops the worker, a running preprocessing is finished first
+     * */
+    ~MapPreprocessor();
+
+    /**
+     * Queues the map behind the given view for preprocessing with
+     * the given configuration. The map memory must stay valid,
+     * as long as the result is in use.
+     * */
+    void submit(const GridView &view, const VFHConf &conf);
+
+    /**
+     * Returns the latest finished result and removes it,
+     * or an empty pointer if there is none. Does not block.
+     * */
+    boost::shared_ptr<VFH> takeResult();
+
+    /**
+     * Blocks until the submitted maps are processed
+     * */
+    void waitIdle();
+
+private:
+    MapPreprocessor(const MapPreprocessor &);
+    MapPreprocessor &operator=(const MapPreprocessor &);
+
+    void run();
+
+    boost::mutex mutex;
+    boost::condition_variable condition;
+    bool stop;
+    bool busy;
+    bool hasPending;
+    GridView pendingView;
+    VFHConf pendingConf;
+    boost::shared_ptr<VFH> result;
+    boost::thread worker;
+};
+
+}
+
+#endif // MAPPREPROCESSOR_HPP
@@ -0,0 +1,35 @@
+#include "MapSnapshot.hpp"
+#include <algorithm>
+
+namespace vfh_star {
+
+MapSnapshot::MapSnapshot()
+{
+}
+
+MapSnapshotPtr MapSnapshot::create(const GridView& source, const VFHConf& conf)
+{
+    boost::shared_ptr<MapSnapshot> snapshot(new MapSnapshot());
+
+    //copy the cells without the padding of the source rows
+    const int width = source.getWidth();
+    const int height = source.getHeight();
+    snapshot->cells.resize(width * height);
+    for(int y = 0; y < height; y++)
+    {
+        const uint8_t *row = source.getData() + y * source.getStride();
+        std::copy(row, row + width, snapshot->cells.begin() + y * width);
+    }
+
+    snapshot->view = GridView(&snapshot->cells[0], width, height, width,
+                              source.getScale(), source.getOffsetX(), source.getOffsetY());
+    for(int i = 0; i < 256; i++)
+        snapshot->view.setObstacleClass(i, source.isObstacleClass(i));
+
+    snapshot->vfh.setConfig(conf);
+    snapshot->vfh.setNewGridView(snapshot->view);
+
+    return snapshot;
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef MAPSNAPSHOT_HPP
+#define MAPSNAPSHOT_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "VFH.h"
+
+namespace vfh_star {
+
+class MapSnapshot;
+typedef boost::shared_ptr<const MapSnapshot> MapSnapshotPtr;
+
+/**
+ * Immutable map together with all derived maps of VFH.
+ *
+ * A snapshot owns a copy of the map cells and is only handed out as
+ * pointer to const. All queries of VFH are const and do not touch any
+ * shared scratch data, so any number of planners on any threads may
+ * use the same snapshot concurrently. The per search data is kept by
+ * each planner, see VFHStar::setMapSnapshot.
+ * */
+class MapSnapshot
+{
+public:
+    /**
+     * Copies the map behind the given view and computes
+     * the derived maps for the given configuration
+     * */
+    static MapSnapshotPtr create(const GridView &view, const VFHConf &conf);
+
+    const VFH &getVFH() const
+    {
+        return vfh;
+    }
+
+    /**
+     * View of the map copy owned by the snapshot
+     * */
+    const GridView &getGridView() const
+    {
+        return view;
+    }
+
+private:
+    MapSnapshot();
+    MapSnapshot(const MapSnapshot &);
+    MapSnapshot &operator=(const MapSnapshot &);
+
+    std::vector<uint8_t> cells;
+    GridView view;
+    VFH vfh;
+};
+
+}
+
+#endif // MAPSNAPSHOT_HPP
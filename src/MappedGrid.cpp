@@ -0,0 +1,141 @@
+#include "MappedGrid.hpp"
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace vfh_star {
+
+namespace {
+
+const char fileMagic[8] = {'V', 'F', 'H', 'M', 'A', 'P', '0', '1'};
+
+//the cells start at this offset, which is a multiple of the page size
+const size_t dataOffset = 4096;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    double scale;
+    double offsetX;
+    double offsetY;
+    uint8_t obstacleClasses[256];
+};
+
+}
+
+MappedGrid::MappedGrid(const std::string& fileName) : mapping(MAP_FAILED), mappingSize(0), cells(NULL)
+{
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("MappedGrid: Error, could not open " + fileName);
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < dataOffset)
+    {
+        close(fd);
+        throw std::runtime_error("MappedGrid: Error, " + fileName + " is not a map file");
+    }
+
+    mappingSize = st.st_size;
+    mapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        throw std::runtime_error("MappedGrid: Error, could not map " + fileName);
+
+    //the planner only looks at windows of the map, read ahead would
+    //fault in pages of rows that are never used
+    madvise(mapping, mappingSize, MADV_RANDOM);
+
+    FileHeader header;
+    memcpy(&header, mapping, sizeof(header));
+    if(memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 || !header.width || !header.height ||
+       header.scale <= 0 || mappingSize < dataOffset + static_cast<size_t>(header.width) * header.height)
+    {
+        munmap(mapping, mappingSize);
+        throw std::runtime_error("MappedGrid: Error, " + fileName + " is not a map file or is truncated");
+    }
+
+    cells = static_cast<const uint8_t *>(mapping) + dataOffset;
+    width = header.width;
+    height = header.height;
+    scale = header.scale;
+    offsetX = header.offsetX;
+    offsetY = header.offsetY;
+    memcpy(obstacleClasses, header.obstacleClasses, sizeof(obstacleClasses));
+}
+
+MappedGrid::~MappedGrid()
+{
+    munmap(mapping, mappingSize);
+}
+
+void MappedGrid::write(const std::string& fileName, const GridView& view)
+{
+    if(!view.isValid())
+        throw std::runtime_error("MappedGrid::write: Error, invalid view");
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.width = view.getWidth();
+    header.height = view.getHeight();
+    header.scale = view.getScale();
+    header.offsetX = view.getOffsetX();
+    header.offsetY = view.getOffsetY();
+    for(int i = 0; i < 256; i++)
+        header.obstacleClasses[i] = view.isObstacleClass(i);
+
+    FILE *file = fopen(fileName.c_str(), "wb");
+    if(!file)
+        throw std::runtime_error("MappedGrid::write: Error, could not open " + fileName);
+
+    std::vector<uint8_t> headerPage(dataOffset, 0);
+    memcpy(&headerPage[0], &header, sizeof(header));
+    bool ok = fwrite(&headerPage[0], 1, headerPage.size(), file) == headerPage.size();
+    for(int y = 0; ok && y < view.getHeight(); y++)
+        ok = fwrite(view.getData() + y * view.getStride(), 1, view.getWidth(), file) == static_cast<size_t>(view.getWidth());
+
+    if(fclose(file) != 0 || !ok)
+        throw std::runtime_error("MappedGrid::write: Error, could not write " + fileName);
+}
+
+GridView MappedGrid::getView() const
+{
+    return getView(0, 0, width, height);
+}
+
+GridView MappedGrid::getView(int minX, int minY, int viewWidth, int viewHeight) const
+{
+    const int maxX = std::min(width, minX + viewWidth);
+    const int maxY = std::min(height, minY + viewHeight);
+    minX = std::max(0, minX);
+    minY = std::max(0, minY);
+    if(maxX <= minX || maxY <= minY)
+        throw std::runtime_error("MappedGrid::getView: Error, window is outside of the map");
+
+    GridView view(cells + static_cast<size_t>(minY) * width + minX, maxX - minX, maxY - minY, width,
+                  scale, offsetX + minX * scale, offsetY + minY * scale);
+    for(int i = 0; i < 256; i++)
+        view.setObstacleClass(i, obstacleClasses[i]);
+
+    return view;
+}
+
+GridView MappedGrid::getView(double x, double y, double size) const
+{
+    const int windowCells = ceil(size / scale);
+    const int minX = floor((x - offsetX) / scale) - windowCells / 2;
+    const int minY = floor((y - offsetY) / scale) - windowCells / 2;
+    return getView(minX, minY, windowCells, windowCells);
+}
+
+}
@@ -0,0 +1,86 @@
+#ifndef MAPPEDGRID_HPP
+#define MAPPEDGRID_HPP
+
+#include <stdint.h>
+#include <string>
+#include "GridView.hpp"
+
+namespace vfh_star {
+
+/**
+ * Traversability map in a memory mapped file.
+ *
+ * The file starts with a header containing the size, the cell size,
+ * the origin and the class to obstacle table of the map. The class ids
+ * follow at a page aligned offset, one byte per cell, row by row.
+ *
+ * Opening a map only maps the file, no cells are read. Views of
+ * windows of the map are plain GridViews into the mapping, so only the
+ * pages of the rows touched by the window are faulted in. This way the
+ * startup time of the planner does not depend on the size of the map.
+ * */
+class MappedGrid
+{
+public:
+    /**
+     * Maps the given file read only. Throws if the
+     * file can not be opened or is not a map file.
+     * */
+    explicit MappedGrid(const std::string &fileName);
+    ~MappedGrid();
+
+    /**
+     * Writes the map behind the given view into a map file
+     * */
+    static void write(const std::string &fileName, const GridView &view);
+
+    /**
+     * Returns a view of the whole map
+     * */
+    GridView getView() const;
+
+    /**
+     * Returns a view of the given window (in cells) of the map. The
+     * window is clipped to the map. Throws if nothing of it is left.
+     * */
+    GridView getView(int minX, int minY, int width, int height) const;
+
+    /**
+     * Returns a view of the square window with the given size
+     * in meters around the given position
+     * */
+    GridView getView(double x, double y, double size) const;
+
+    int getWidth() const
+    {
+        return width;
+    }
+
+    int getHeight() const
+    {
+        return height;
+    }
+
+    double getScale() const
+    {
+        return scale;
+    }
+
+private:
+    MappedGrid(const MappedGrid &);
+    MappedGrid &operator=(const MappedGrid &);
+
+    void *mapping;
+    size_t mappingSize;
+    const uint8_t *cells;
+    int width;
+    int height;
+    double scale;
+    double offsetX;
+    double offsetY;
+    uint8_t obstacleClasses[256];
+};
+
+}
+
+#endif // MAPPEDGRID_HPP
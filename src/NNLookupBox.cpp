@@ -7,7 +7,7 @@ NNLookupBox::NNLookupBox(double resolutionXY, double angularResoultion, double s
 {
     xCells = size / resolutionXY + 1;
     yCells = xCells;
-    aCells = M_PI / angularResoultion * 2 + 1;
+    aCells = ceil(2 * M_PI / angularResoultion);
 
     hashMap.resize(xCells);
     for(int x = 0; x < xCells; x++)
@@ -52,9 +52,7 @@ bool NNLookupBox::getIndixes(const TreeNode &node, int& x, int& y, int& a) const
 //     std::cout << "NodePos " << node.getPosition().transpose() << " mapPos " << mapPos.transpose() << std::endl;
     x = mapPos.x() / resolutionXY;
     y = mapPos.y() / resolutionXY;
-    a = node.getYaw().getRad() / angularResolution;
-    if(a < 0)
-        a+= M_PI/angularResolution * 2.0;
+    a = node.getBinaryYaw().getBin(aCells);
 
 //     std::cout << "X " << x << " Y " << y << " A " << a << std::endl;
     
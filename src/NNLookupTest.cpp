@@ -1,12 +1,21 @@
 #include <iostream>
 #include <stdlib.h>
 #include <base/Angle.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
 #define private public 
 #include "vfh_star/TreeSearch.h"
+#include "vfh_star/ConcurrentNNLookup.hpp"
 
 using namespace Eigen;
 using namespace vfh_star;
 
+void setNodes(ConcurrentNNLookup *lookup, const std::vector<TreeNode> *nodes, int start, int end)
+{
+    for(int i = start; i < end; i++)
+        lookup->setNode((*nodes)[i]);
+}
+
 int main()
 {
     
@@ -27,10 +36,10 @@ int main()
 	
 	std::cout << "X " << x << " Y " << y << std::endl;
 
-	nodes[i].pose.position.x() = x;
-	nodes[i].pose.position.y() = y;
-	nodes[i].direction = base::Angle::fromRad(0.1);
-        nodes[i].yaw = base::Angle::fromRad(0.1);
+	nodes[i].position.x() = x;
+	nodes[i].position.y() = y;
+	nodes[i].direction = BinaryAngle::fromRad(0.1);
+        nodes[i].yaw = BinaryAngle::fromRad(0.1);
         nodes[i].setDriveModeNr(0);
 	
 	l.setNode(&(nodes[i]));
@@ -44,5 +53,47 @@ int main()
 	bool correct __attribute__((unused)) = otherNode->getPosition() == nodes[i].getPosition();
 	assert(correct);
     }
+
+    //several threads set copies of the nodes with random costs,
+    //the cheapest copy of every cell has to win
+    const int nrThreads = 4;
+    ConcurrentNNLookup cl(0.05, 3.0/180.0*M_PI, iterations);
+    std::vector<TreeNode> copies(nrThreads * iterations);
+    for(int i = 0; i < nrThreads * iterations; i++)
+    {
+        copies[i].position = nodes[i % iterations].position;
+        copies[i].orientation = nodes[i % iterations].orientation;
+        copies[i].yaw = nodes[i % iterations].yaw;
+        copies[i].setDriveModeNr(0);
+        copies[i].index = i;
+        copies[i].setCost(random() % 100);
+    }
+    
+    boost::thread_group threads;
+    for(int t = 0; t < nrThreads; t++)
+        threads.create_thread(boost::bind(&setNodes, &cl, &copies, t * iterations, (t + 1) * iterations));
+    threads.join_all();
+    
+    for(int i = 0; i < nrThreads * iterations; i++)
+    {
+        const int best = cl.getNodeWithinBounds(copies[i]);
+        assert(best >= 0);
+        
+        bool correct __attribute__((unused)) = copies[best].getPosition() == copies[i].getPosition() &&
+            (copies[best].getCost() < copies[i].getCost() || (copies[best].getCost() == copies[i].getCost() && best <= i));
+        assert(correct);
+    }
+    
+    //removing the winner empties the cell, removing others does not
+    const int best = cl.getNodeWithinBounds(copies[0]);
+    if(best != 0)
+    {
+        cl.clearIfSame(copies[0]);
+        assert(cl.getNodeWithinBounds(copies[0]) == best);
+    }
+    cl.clearIfSame(copies[best]);
+    assert(cl.getNodeWithinBounds(copies[0]) == -1);
+    
+    std::cout << "ConcurrentNNLookup passed" << std::endl;
 	
 };
\ No newline at end of file
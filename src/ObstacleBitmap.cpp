@@ -0,0 +1,222 @@
+#include "ObstacleBitmap.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace vfh_star {
+
+ObstacleBitmap::ObstacleBitmap() : width(0), height(0), padding(0), wordsPerRow(0)
+{
+}
+
+void ObstacleBitmap::resize(int width, int height, int padding)
+{
+    this->width = width;
+    this->height = height;
+    this->padding = padding;
+    wordsPerRow = (width + 2 * padding + 63) / 64;
+    words.assign(wordsPerRow * (height + 2 * padding), 0);
+
+    if(!padding)
+        return;
+
+    //mark the padding as obstacle
+    for(int y = -padding; y < height + padding; y++)
+    {
+        if(y < 0 || y >= height)
+        {
+            setSpan(y, -padding, width + padding - 1, true);
+        }
+        else
+        {
+            setSpan(y, -padding, -1, true);
+            setSpan(y, width, width + padding - 1, true);
+        }
+    }
+}
+
+void ObstacleBitmap::setSpan(int y, int x0, int x1, bool obstacle)
+{
+    if(x0 > x1)
+        return;
+
+    uint64_t *row = &words[(y + padding) * wordsPerRow];
+    const uint64_t allSet = ~static_cast<uint64_t>(0);
+    const int px0 = x0 + padding;
+    const int px1 = x1 + padding;
+    const int firstWord = px0 >> 6;
+    const int lastWord = px1 >> 6;
+    for(int w = firstWord; w <= lastWord; w++)
+    {
+        uint64_t mask = allSet;
+        if(w == firstWord)
+            mask &= allSet << (px0 & 63);
+        if(w == lastWord)
+            mask &= allSet >> (63 - (px1 & 63));
+
+        if(obstacle)
+            row[w] |= mask;
+        else
+            row[w] &= ~mask;
+    }
+}
+
+void ObstacleBitmap::shift(int dx, int dy)
+{
+    if(abs(dx) >= width || abs(dy) >= height)
+    {
+        for(int y = 0; y < height; y++)
+            setSpan(y, 0, width - 1, false);
+        return;
+    }
+
+    //move the rows, the padding rows stay in place
+    if(dy > 0)
+    {
+        for(int y = 0; y < height - dy; y++)
+            std::copy(&words[(y + dy + padding) * wordsPerRow], &words[(y + dy + padding + 1) * wordsPerRow],
+                      &words[(y + padding) * wordsPerRow]);
+    }
+    else if(dy < 0)
+    {
+        for(int y = height - 1; y >= -dy; y--)
+            std::copy(&words[(y + dy + padding) * wordsPerRow], &words[(y + dy + padding + 1) * wordsPerRow],
+                      &words[(y + padding) * wordsPerRow]);
+    }
+
+    for(int y = 0; y < height; y++)
+    {
+        const bool exposedRow = (dy > 0 && y >= height - dy) || (dy < 0 && y < -dy);
+        if(exposedRow)
+        {
+            setSpan(y, 0, width - 1, false);
+            continue;
+        }
+
+        if(!dx)
+            continue;
+
+        //move the bits of the row. Bit i of the shifted row
+        //is bit i + dx of the old one
+        uint64_t *row = &words[(y + padding) * wordsPerRow];
+        const int wordShift = (dx > 0 ? dx : -dx) >> 6;
+        const int bitShift = (dx > 0 ? dx : -dx) & 63;
+        if(dx > 0)
+        {
+            for(int w = 0; w < wordsPerRow; w++)
+            {
+                const int src = w + wordShift;
+                uint64_t v = src < wordsPerRow ? row[src] >> bitShift : 0;
+                if(bitShift && src + 1 < wordsPerRow)
+                    v |= row[src + 1] << (64 - bitShift);
+                row[w] = v;
+            }
+        }
+        else
+        {
+            for(int w = wordsPerRow - 1; w >= 0; w--)
+            {
+                const int src = w - wordShift;
+                uint64_t v = src >= 0 ? row[src] << bitShift : 0;
+                if(bitShift && src - 1 >= 0)
+                    v |= row[src - 1] >> (64 - bitShift);
+                row[w] = v;
+            }
+        }
+
+        //clear the exposed cells and restore the padding
+        if(dx > 0)
+            setSpan(y, width - dx, width - 1, false);
+        else
+            setSpan(y, 0, -dx - 1, false);
+
+        if(padding)
+        {
+            setSpan(y, -padding, -1, true);
+            setSpan(y, width, width + padding - 1, true);
+        }
+
+        //cells behind the padding stay free
+        const int usedBits = (width + 2 * padding) & 63;
+        if(usedBits)
+            row[wordsPerRow - 1] &= ~static_cast<uint64_t>(0) >> (64 - usedBits);
+    }
+}
+
+void ObstacleBitmap::swap(ObstacleBitmap& other)
+{
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    std::swap(padding, other.padding);
+    std::swap(wordsPerRow, other.wordsPerRow);
+    words.swap(other.words);
+}
+
+void ObstacleBitmap::setObstacle(int x, int y, bool obstacle)
+{
+    const int px = x + padding;
+    const uint64_t mask = static_cast<uint64_t>(1) << (px & 63);
+    uint64_t &word(words[(y + padding) * wordsPerRow + (px >> 6)]);
+    if(obstacle)
+        word |= mask;
+    else
+        word &= ~mask;
+}
+
+bool ObstacleBitmap::hasObstacleInSpan(int y, int x0, int x1) const
+{
+    //go safe, everything outside is an obstacle
+    if(y < -padding || y >= height + padding || x0 < -padding || x1 >= width + padding)
+        return true;
+
+    const uint64_t *row = &words[(y + padding) * wordsPerRow];
+    const uint64_t allSet = ~static_cast<uint64_t>(0);
+    const int px0 = x0 + padding;
+    const int px1 = x1 + padding;
+    const int firstWord = px0 >> 6;
+    const int lastWord = px1 >> 6;
+    const uint64_t firstMask = allSet << (px0 & 63);
+    const uint64_t lastMask = allSet >> (63 - (px1 & 63));
+
+    if(firstWord == lastWord)
+        return row[firstWord] & firstMask & lastMask;
+
+    if(row[firstWord] & firstMask)
+        return true;
+
+    for(int w = firstWord + 1; w < lastWord; w++)
+    {
+        if(row[w])
+            return true;
+    }
+
+    return row[lastWord] & lastMask;
+}
+
+int ObstacleBitmap::findNextObstacle(int y, int x0, int x1) const
+{
+    if(x0 > x1)
+        return x1 + 1;
+
+    const uint64_t *row = &words[(y + padding) * wordsPerRow];
+    const int px0 = x0 + padding;
+    const int px1 = x1 + padding;
+    const int lastWord = px1 >> 6;
+
+    int w = px0 >> 6;
+    uint64_t bits = row[w] & (~static_cast<uint64_t>(0) << (px0 & 63));
+    while(true)
+    {
+        if(bits)
+        {
+            const int px = w * 64 + __builtin_ctzll(bits);
+            return px <= px1 ? px - padding : x1 + 1;
+        }
+
+        w++;
+        if(w > lastWord)
+            return x1 + 1;
+        bits = row[w];
+    }
+}
+
+}
@@ -0,0 +1,128 @@
+#ifndef OBSTACLEBITMAP_HPP
+#define OBSTACLEBITMAP_HPP
+
+#include <stdint.h>
+#include <vector>
+
+namespace vfh_star {
+
+/**
+ * Grid of obstacle bits, packed into 64 bit words.
+ * Every row starts at a word boundary, so that
+ * spans of a row can be tested word wise.
+ *
+ * The grid is surrounded by a border of padding cells,
+ * which are obstacles. Accesses within the padding do
+ * not need any bounds checks.
+ * */
+class ObstacleBitmap
+{
+public:
+    ObstacleBitmap();
+
+    /**
+     * Resizes the bitmap, marks all cells as free and
+     * the given number of padding cells around it as obstacles
+     * */
+    void resize(int width, int height, int padding = 0);
+
+    /**
+     * Exchanges the contents of both bitmaps
+     * */
+    void swap(ObstacleBitmap &other);
+
+    void setObstacle(int x, int y, bool obstacle);
+
+    /**
+     * Sets the cells x0 to x1 (both inclusive) of row y. The
+     * span must be within the bitmap or its padding.
+     * */
+    void setSpan(int y, int x0, int x1, bool obstacle);
+
+    /**
+     * Moves the content of the bitmap, so that afterwards the cell
+     * (x, y) contains what was in the cell (x + dx, y + dy) before.
+     * Cells, that had no source within the bitmap are free afterwards,
+     * the padding stays unchanged.
+     * */
+    void shift(int dx, int dy);
+
+    /**
+     * Returns true if the cell is an obstacle.
+     * Everything outside of the bitmap is considered an obstacle.
+     * */
+    bool isObstacle(int x, int y) const
+    {
+        if(x < -padding || y < -padding || x >= width + padding || y >= height + padding)
+            return true;
+
+        return isObstacleUnchecked(x, y);
+    }
+
+    /**
+     * Same as isObstacle, but without bounds check. The
+     * cell must be within the bitmap or its padding.
+     * */
+    bool isObstacleUnchecked(int x, int y) const
+    {
+        const int px = x + padding;
+        return (words[(y + padding) * wordsPerRow + (px >> 6)] >> (px & 63)) & 1;
+    }
+
+    /**
+     * Returns true if there is an obstacle in row y
+     * between x0 and x1 (both inclusive).
+     * */
+    bool hasObstacleInSpan(int y, int x0, int x1) const;
+
+    /**
+     * Returns the first obstacle in row y between x0 and x1
+     * (both inclusive), or x1 + 1 if there is none. The span
+     * must be within the bitmap or its padding.
+     * */
+    int findNextObstacle(int y, int x0, int x1) const;
+
+    /**
+     * Returns the obstacle bits of the cells x to x + 7 in row y,
+     * the bit of cell x is the lowest one. Cells behind the
+     * padding are returned as free. The cell x must be within
+     * the bitmap or its padding.
+     * */
+    uint8_t getByte(int y, int x) const
+    {
+        const uint64_t *row = &words[(y + padding) * wordsPerRow];
+        const int px = x + padding;
+        const int w = px >> 6;
+        const int shift = px & 63;
+        uint64_t bits = row[w] >> shift;
+        if(shift > 56 && w + 1 < wordsPerRow)
+            bits |= row[w + 1] << (64 - shift);
+        return bits & 0xff;
+    }
+
+    int getWidth() const
+    {
+        return width;
+    }
+
+    int getHeight() const
+    {
+        return height;
+    }
+
+    int getPadding() const
+    {
+        return padding;
+    }
+
+private:
+    int width;
+    int height;
+    int padding;
+    int wordsPerRow;
+    std::vector<uint64_t> words;
+};
+
+}
+
+#endif // OBSTACLEBITMAP_HPP
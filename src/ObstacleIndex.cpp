@@ -0,0 +1,114 @@
+#include "ObstacleIndex.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace vfh_star {
+
+ObstacleIndex::ObstacleIndex() : tilesX(0), tilesY(0)
+{
+}
+
+bool ObstacleIndex::isEmpty() const
+{
+    return tileStart.empty();
+}
+
+void ObstacleIndex::swap(ObstacleIndex& other)
+{
+    std::swap(tilesX, other.tilesX);
+    std::swap(tilesY, other.tilesY);
+    tileStart.swap(other.tileStart);
+    cells.swap(other.cells);
+}
+
+void ObstacleIndex::clear()
+{
+    tileStart.clear();
+    cells.clear();
+    tilesX = 0;
+    tilesY = 0;
+}
+
+void ObstacleIndex::compute(const ObstacleBitmap& obstacles)
+{
+    const int width = obstacles.getWidth();
+    const int height = obstacles.getHeight();
+    if(width > 0xffff || height > 0xffff)
+        throw std::runtime_error("ObstacleIndex::compute: Error, grid is too large for the index");
+
+    tilesX = (width + tileSize - 1) / tileSize;
+    tilesY = (height + tileSize - 1) / tileSize;
+
+    tileStart.resize(tilesX * tilesY + 1);
+    cells.clear();
+
+    for(int ty = 0; ty < tilesY; ty++)
+    {
+        for(int tx = 0; tx < tilesX; tx++)
+        {
+            tileStart[ty * tilesX + tx] = cells.size();
+            addTileCells(obstacles, tx, ty, cells);
+        }
+    }
+    tileStart.back() = cells.size();
+}
+
+void ObstacleIndex::update(const ObstacleBitmap& obstacles, int minX, int minY, int maxX, int maxY)
+{
+    if(isEmpty())
+        return;
+
+    if((obstacles.getWidth() + tileSize - 1) / tileSize != tilesX || (obstacles.getHeight() + tileSize - 1) / tileSize != tilesY)
+        throw std::runtime_error("ObstacleIndex::update: Error, the size of the grid changed");
+
+    const int minTileX = std::max(0, minX / tileSize);
+    const int minTileY = std::max(0, minY / tileSize);
+    const int maxTileX = std::min(tilesX - 1, maxX / tileSize);
+    const int maxTileY = std::min(tilesY - 1, maxY / tileSize);
+
+    //the cells of all tiles are stored consecutively, so the
+    //unchanged tiles are copied into a new cell list
+    std::vector<Cell> newCells;
+    newCells.reserve(cells.size());
+    for(int ty = 0; ty < tilesY; ty++)
+    {
+        for(int tx = 0; tx < tilesX; tx++)
+        {
+            const int tile = ty * tilesX + tx;
+            const int start = newCells.size();
+            if(tx >= minTileX && tx <= maxTileX && ty >= minTileY && ty <= maxTileY)
+                addTileCells(obstacles, tx, ty, newCells);
+            else
+                newCells.insert(newCells.end(), cells.begin() + tileStart[tile], cells.begin() + tileStart[tile + 1]);
+            //the old range of the tile was read already
+            tileStart[tile] = start;
+        }
+    }
+
+    tileStart.back() = newCells.size();
+    cells.swap(newCells);
+}
+
+void ObstacleIndex::addTileCells(const ObstacleBitmap& obstacles, int tileX, int tileY, std::vector<Cell> &tileCells) const
+{
+    const int xEnd = std::min(obstacles.getWidth(), (tileX + 1) * tileSize);
+    const int yEnd = std::min(obstacles.getHeight(), (tileY + 1) * tileSize);
+    for(int y = tileY * tileSize; y < yEnd; y++)
+    {
+        if(!obstacles.hasObstacleInSpan(y, tileX * tileSize, xEnd - 1))
+            continue;
+
+        for(int x = tileX * tileSize; x < xEnd; x++)
+        {
+            if(!obstacles.isObstacle(x, y))
+                continue;
+
+            Cell cell;
+            cell.x = x;
+            cell.y = y;
+            tileCells.push_back(cell);
+        }
+    }
+}
+
+}
@@ -0,0 +1,92 @@
+#ifndef OBSTACLEINDEX_HPP
+#define OBSTACLEINDEX_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "ObstacleBitmap.hpp"
+
+namespace vfh_star {
+
+/**
+ * Spatial index of the obstacle cells of a grid.
+ *
+ * The grid is split into tiles of tileSize x tileSize cells. For
+ * every tile the obstacle cells are stored in a list, so that
+ * scans over an area only visit the obstacles within it and can
+ * skip free tiles entirely.
+ * */
+class ObstacleIndex
+{
+public:
+    struct Cell
+    {
+        uint16_t x;
+        uint16_t y;
+    };
+
+    static const int tileSize = 8;
+
+    ObstacleIndex();
+
+    void compute(const ObstacleBitmap &obstacles);
+
+    /**
+     * Recomputes the tiles that contain cells of the given area
+     * (both corners inclusive). The other tiles are copied. The size
+     * of the obstacle bitmap must not have changed since the last compute.
+     * */
+    void update(const ObstacleBitmap &obstacles, int minX, int minY, int maxX, int maxY);
+
+    bool isEmpty() const;
+
+    void clear();
+
+    void swap(ObstacleIndex &other);
+
+    int getTilesX() const
+    {
+        return tilesX;
+    }
+
+    int getTilesY() const
+    {
+        return tilesY;
+    }
+
+    /**
+     * Returns true if the tile does not contain any obstacle
+     * */
+    bool isTileFree(int tileX, int tileY) const
+    {
+        const int tile = tileY * tilesX + tileX;
+        return tileStart[tile] == tileStart[tile + 1];
+    }
+
+    /**
+     * Returns the obstacle cells of the given tile as
+     * range [begin, end)
+     * */
+    const Cell *getTileBegin(int tileX, int tileY) const
+    {
+        return &cells[0] + tileStart[tileY * tilesX + tileX];
+    }
+
+    const Cell *getTileEnd(int tileX, int tileY) const
+    {
+        return &cells[0] + tileStart[tileY * tilesX + tileX + 1];
+    }
+
+private:
+    void addTileCells(const ObstacleBitmap &obstacles, int tileX, int tileY, std::vector<Cell> &tileCells) const;
+
+    int tilesX;
+    int tilesY;
+
+    ///index of the first cell of every tile in cells, plus the end index
+    std::vector<int> tileStart;
+    std::vector<Cell> cells;
+};
+
+}
+
+#endif // OBSTACLEINDEX_HPP
@@ -0,0 +1,84 @@
+#include "ObstacleTiles.hpp"
+#include <stdexcept>
+
+namespace vfh_star {
+
+ObstacleTiles::ObstacleTiles() : padding(0), tilesX(0), tilesY(0), blocksX(0)
+{
+}
+
+bool ObstacleTiles::isEmpty() const
+{
+    return tiles.empty();
+}
+
+void ObstacleTiles::swap(ObstacleTiles& other)
+{
+    std::swap(padding, other.padding);
+    std::swap(tilesX, other.tilesX);
+    std::swap(tilesY, other.tilesY);
+    std::swap(blocksX, other.blocksX);
+    tiles.swap(other.tiles);
+}
+
+void ObstacleTiles::clear()
+{
+    tiles.clear();
+    tilesX = 0;
+    tilesY = 0;
+    blocksX = 0;
+}
+
+void ObstacleTiles::compute(const ObstacleBitmap& obstacles)
+{
+    padding = obstacles.getPadding();
+    const int paddedWidth = obstacles.getWidth() + 2 * padding;
+    const int paddedHeight = obstacles.getHeight() + 2 * padding;
+    tilesX = (paddedWidth + tileSize - 1) / tileSize;
+    tilesY = (paddedHeight + tileSize - 1) / tileSize;
+
+    blocksX = (tilesX + blockMask) >> blockShift;
+    const int blocksY = (tilesY + blockMask) >> blockShift;
+    tiles.assign((blocksX * blocksY) << (2 * blockShift), 0);
+
+    for(int ty = 0; ty < tilesY; ty++)
+    {
+        for(int tx = 0; tx < tilesX; tx++)
+            computeTile(obstacles, tx, ty);
+    }
+}
+
+void ObstacleTiles::update(const ObstacleBitmap& obstacles, int minX, int minY, int maxX, int maxY)
+{
+    if(isEmpty())
+        return;
+
+    if(obstacles.getPadding() != padding || (obstacles.getWidth() + 2 * padding + tileSize - 1) / tileSize != tilesX
+        || (obstacles.getHeight() + 2 * padding + tileSize - 1) / tileSize != tilesY)
+        throw std::runtime_error("ObstacleTiles::update: Error, the size of the grid changed");
+
+    for(int ty = getTileY(minY); ty <= getTileY(maxY); ty++)
+    {
+        for(int tx = getTileX(minX); tx <= getTileX(maxX); tx++)
+            computeTile(obstacles, tx, ty);
+    }
+}
+
+void ObstacleTiles::computeTile(const ObstacleBitmap& obstacles, int tileX, int tileY)
+{
+    const int originX = getTileOriginX(tileX);
+    const int originY = getTileOriginY(tileY);
+    const int endY = obstacles.getHeight() + padding;
+    uint64_t tile = 0;
+    for(int row = 0; row < tileSize; row++)
+    {
+        //rows behind the padding are never scanned
+        if(originY + row >= endY)
+            break;
+
+        tile |= static_cast<uint64_t>(obstacles.getByte(originY + row, originX)) << (row * tileSize);
+    }
+    tiles[getTileIndex(tileX, tileY)] = tile;
+}
+
+}
@@ -0,0 +1,121 @@
+#ifndef OBSTACLETILES_HPP
+#define OBSTACLETILES_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "ObstacleBitmap.hpp"
+
+namespace vfh_star {
+
+/**
+ * Copy of an obstacle bitmap in a cache friendly layout for area scans.
+ *
+ * The bitmap including its padding is split into tiles of 8 x 8 cells.
+ * Every tile is stored in one 64 bit word, the bit of the cell
+ * (x, y) within the tile is y * 8 + x. The tiles are grouped into
+ * blocks of 8 x 8 tiles, which are stored row by row. Within a block
+ * the tiles are stored in Morton (Z) order, so that tiles close to
+ * each other in the grid are close to each other in memory and a disc
+ * scan touches only a few cache lines. Only the blocks covering the
+ * bitmap are allocated, so long and narrow maps waste at most one row
+ * and one column of blocks.
+ * */
+class ObstacleTiles
+{
+public:
+    static const int tileSize = 8;
+
+    ObstacleTiles();
+
+    void compute(const ObstacleBitmap &obstacles);
+
+    /**
+     * Recomputes the tiles that contain cells of the given area
+     * (both corners inclusive). The size of the obstacle bitmap
+     * must not have changed since the last compute.
+     * */
+    void update(const ObstacleBitmap &obstacles, int minX, int minY, int maxX, int maxY);
+
+    bool isEmpty() const;
+
+    void clear();
+
+    void swap(ObstacleTiles &other);
+
+    /**
+     * Returns the tile that contains the cell x
+     * */
+    int getTileX(int x) const
+    {
+        return (x + padding) >> 3;
+    }
+
+    int getTileY(int y) const
+    {
+        return (y + padding) >> 3;
+    }
+
+    /**
+     * Returns the cell coordinate of the first cell of the tile
+     * */
+    int getTileOriginX(int tileX) const
+    {
+        return tileX * tileSize - padding;
+    }
+
+    int getTileOriginY(int tileY) const
+    {
+        return tileY * tileSize - padding;
+    }
+
+    /**
+     * Returns the obstacle bits of the given tile.
+     * Tiles outside of the padded bitmap are obstacles.
+     * */
+    uint64_t getTile(int tileX, int tileY) const
+    {
+        if(tileX < 0 || tileY < 0 || tileX >= tilesX || tileY >= tilesY)
+            return ~static_cast<uint64_t>(0);
+
+        return tiles[getTileIndex(tileX, tileY)];
+    }
+
+private:
+    void computeTile(const ObstacleBitmap &obstacles, int tileX, int tileY);
+
+    /**
+     * Spreads the lower 3 bits of v to the even bits
+     * */
+    static uint32_t interleave(uint32_t v)
+    {
+        v = (v | (v << 2)) & 0x33;
+        v = (v | (v << 1)) & 0x55;
+        return v;
+    }
+
+    /**
+     * Returns the index of the tile in tiles: the first tile of its
+     * block plus the Morton index of the tile within the block
+     * */
+    int getTileIndex(int tileX, int tileY) const
+    {
+        const int block = (tileY >> blockShift) * blocksX + (tileX >> blockShift);
+        return (block << (2 * blockShift)) | interleave(tileX & blockMask) | (interleave(tileY & blockMask) << 1);
+    }
+
+    ///blocks have 2^blockShift x 2^blockShift tiles
+    static const int blockShift = 3;
+    static const int blockMask = (1 << blockShift) - 1;
+
+    int padding;
+    int tilesX;
+    int tilesY;
+    int blocksX;
+
+    ///blocks of tiles row by row, tiles in Morton order within a block
+    std::vector<uint64_t> tiles;
+};
+
+}
+
+#endif // OBSTACLETILES_HPP
@@ -0,0 +1,512 @@
+#include "PlanCapture.hpp"
+#include "TreeNode.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace vfh_star {
+
+namespace {
+
+const char fileMagic[8] = {'V', 'F', 'H', 'C', 'A', 'P', '0', '3'};
+
+enum MapEncoding
+{
+    MAP_FULL = 0,
+    MAP_DELTA = 1
+};
+
+//two runs are merged if less unchanged cells than
+//the size of a run header are in between
+const size_t runHeaderSize = 2 * sizeof(uint32_t);
+
+template <class T>
+void writeValue(FILE *file, const T &value)
+{
+    if(fwrite(&value, sizeof(T), 1, file) != 1)
+        throw std::runtime_error("PlanCaptureWriter: Error, could not write to capture file");
+}
+
+/**
+ * Appends the value like it would be written to a capture
+ * file, used to compare configurations
+ * */
+template <class T>
+void writeValue(std::vector<uint8_t> *buffer, const T &value)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    buffer->insert(buffer->end(), bytes, bytes + sizeof(T));
+}
+
+void writeBytes(FILE *file, const uint8_t *data, size_t size)
+{
+    if(size && fwrite(data, 1, size, file) != size)
+        throw std::runtime_error("PlanCaptureWriter: Error, could not write to capture file");
+}
+
+template <class T>
+void readValue(FILE *file, T &value)
+{
+    if(fread(&value, sizeof(T), 1, file) != 1)
+        throw std::runtime_error("PlanCaptureReader: Error, capture file is truncated");
+}
+
+void readBytes(FILE *file, uint8_t *data, size_t size)
+{
+    if(size && fread(data, 1, size, file) != size)
+        throw std::runtime_error("PlanCaptureReader: Error, capture file is truncated");
+}
+
+template <class Output>
+void writeBool(Output file, bool value)
+{
+    writeValue<uint8_t>(file, value);
+}
+
+bool readBool(FILE *file)
+{
+    uint8_t value;
+    readValue(file, value);
+    return value;
+}
+
+template <class Output>
+void writeTime(Output file, const base::Time &time)
+{
+    writeValue<int64_t>(file, time.toMicroseconds());
+}
+
+base::Time readTime(FILE *file)
+{
+    int64_t us;
+    readValue(file, us);
+    return base::Time::fromMicroseconds(us);
+}
+
+void writeVector(FILE *file, const base::Vector3d &v)
+{
+    for(int i = 0; i < 3; i++)
+        writeValue<double>(file, v[i]);
+}
+
+void readVector(FILE *file, base::Vector3d &v)
+{
+    for(int i = 0; i < 3; i++)
+        readValue(file, v[i]);
+}
+
+template <class Output>
+void writeSearchConf(Output file, const TreeSearchConf &conf)
+{
+    writeValue<int32_t>(file, conf.maxTreeSize);
+    writeValue<double>(file, conf.stepDistance);
+    writeValue<uint32_t>(file, conf.sampleAreas.size());
+    for(std::vector<AngleSampleConf>::const_iterator it = conf.sampleAreas.begin(); it != conf.sampleAreas.end(); it++)
+    {
+        writeValue<double>(file, it->angularSamplingMin);
+        writeValue<double>(file, it->angularSamplingMax);
+        writeValue<int32_t>(file, it->angularSamplingNominalCount);
+        writeValue<double>(file, it->intervalStart);
+        writeValue<double>(file, it->intervalWidth);
+    }
+    writeValue<double>(file, conf.discountFactor);
+    writeValue<double>(file, conf.identityPositionThreshold);
+    writeValue<double>(file, conf.identityYawThreshold);
+    writeTime(file, conf.maxSeekTime);
+    writeValue<int32_t>(file, conf.directionBins);
+    writeValue<double>(file, conf.directionEpsilon);
+    writeValue<int32_t>(file, conf.maxChildrenPerExpansion);
+    writeValue<double>(file, conf.clearanceSamplingNear);
+    writeValue<double>(file, conf.clearanceSamplingFar);
+    writeValue<double>(file, conf.samplingDensityMin);
+    writeValue<double>(file, conf.samplingDensityMax);
+    writeValue<double>(file, conf.maxStepDistance);
+    writeValue<double>(file, conf.macroStepClearance);
+    writeValue<uint32_t>(file, conf.resolutionSchedule.size());
+    for(std::vector<SearchResolution>::const_iterator it = conf.resolutionSchedule.begin(); it != conf.resolutionSchedule.end(); it++)
+    {
+        writeValue<double>(file, it->startDistance);
+        writeValue<double>(file, it->stepDistance);
+        writeValue<double>(file, it->angularSamplingScale);
+        writeValue<double>(file, it->identityPositionThreshold);
+        writeValue<double>(file, it->identityYawThreshold);
+    }
+    writeValue<uint32_t>(file, conf.driveModeTransitions.size());
+    for(std::vector<DriveModeTransition>::const_iterator it = conf.driveModeTransitions.begin(); it != conf.driveModeTransitions.end(); it++)
+    {
+        writeValue<int32_t>(file, it->fromDriveMode);
+        writeValue<int32_t>(file, it->toDriveMode);
+        writeBool(file, it->allowed);
+        writeValue<double>(file, it->penalty);
+    }
+    writeValue<int32_t>(file, conf.minDriveModeDwell);
+    const BudgetControlConf &budget(conf.budgetControl);
+    writeTime(file, budget.targetLatency);
+    writeValue<double>(file, budget.percentile);
+    writeValue<int32_t>(file, budget.window);
+    writeValue<int32_t>(file, budget.minTreeSize);
+    writeValue<int32_t>(file, budget.maxTreeSize);
+    writeValue<double>(file, budget.minSamplingScale);
+    writeValue<double>(file, budget.maxHeuristicWeight);
+}
+
+void readSearchConf(FILE *file, TreeSearchConf &conf)
+{
+    int32_t intValue;
+    uint32_t size;
+
+    readValue(file, intValue);
+    conf.maxTreeSize = intValue;
+    readValue(file, conf.stepDistance);
+    readValue(file, size);
+    conf.sampleAreas.resize(size);
+    for(std::vector<AngleSampleConf>::iterator it = conf.sampleAreas.begin(); it != conf.sampleAreas.end(); it++)
+    {
+        readValue(file, it->angularSamplingMin);
+        readValue(file, it->angularSamplingMax);
+        readValue(file, intValue);
+        it->angularSamplingNominalCount = intValue;
+        readValue(file, it->intervalStart);
+        readValue(file, it->intervalWidth);
+    }
+    readValue(file, conf.discountFactor);
+    readValue(file, conf.identityPositionThreshold);
+    readValue(file, conf.identityYawThreshold);
+    conf.maxSeekTime = readTime(file);
+    readValue(file, intValue);
+    conf.directionBins = intValue;
+    readValue(file, conf.directionEpsilon);
+    readValue(file, intValue);
+    conf.maxChildrenPerExpansion = intValue;
+    readValue(file, conf.clearanceSamplingNear);
+    readValue(file, conf.clearanceSamplingFar);
+    readValue(file, conf.samplingDensityMin);
+    readValue(file, conf.samplingDensityMax);
+    readValue(file, conf.maxStepDistance);
+    readValue(file, conf.macroStepClearance);
+    readValue(file, size);
+    conf.resolutionSchedule.resize(size);
+    for(std::vector<SearchResolution>::iterator it = conf.resolutionSchedule.begin(); it != conf.resolutionSchedule.end(); it++)
+    {
+        readValue(file, it->startDistance);
+        readValue(file, it->stepDistance);
+        readValue(file, it->angularSamplingScale);
+        readValue(file, it->identityPositionThreshold);
+        readValue(file, it->identityYawThreshold);
+    }
+    readValue(file, size);
+    conf.driveModeTransitions.resize(size);
+    for(std::vector<DriveModeTransition>::iterator it = conf.driveModeTransitions.begin(); it != conf.driveModeTransitions.end(); it++)
+    {
+        readValue(file, intValue);
+        it->fromDriveMode = intValue;
+        readValue(file, intValue);
+        it->toDriveMode = intValue;
+        it->allowed = readBool(file);
+        readValue(file, it->penalty);
+    }
+    readValue(file, intValue);
+    conf.minDriveModeDwell = intValue;
+    BudgetControlConf &budget(conf.budgetControl);
+    budget.targetLatency = readTime(file);
+    readValue(file, budget.percentile);
+    readValue(file, intValue);
+    budget.window = intValue;
+    readValue(file, intValue);
+    budget.minTreeSize = intValue;
+    readValue(file, intValue);
+    budget.maxTreeSize = intValue;
+    readValue(file, budget.minSamplingScale);
+    readValue(file, budget.maxHeuristicWeight);
+}
+
+template <class Output>
+void writeCostConf(Output file, const VFHStarConf &conf)
+{
+    const VFHConf &vfhConf(conf.vfhConf);
+    writeValue<double>(file, vfhConf.obstacleSafetyDistance);
+    writeValue<double>(file, vfhConf.robotWidth);
+    writeValue<double>(file, vfhConf.robotLength);
+    writeValue<int32_t>(file, vfhConf.footprintYawBins);
+    writeValue<double>(file, vfhConf.maxClearance);
+    writeBool(file, vfhConf.sweptPathCheck);
+    writeValue<double>(file, vfhConf.sweptStepLength);
+    writeValue<double>(file, vfhConf.obstacleSenseRadius);
+    writeValue<int32_t>(file, vfhConf.narrowThreshold);
+    writeValue<double>(file, vfhConf.lowThreshold);
+    writeValue<int32_t>(file, vfhConf.histogramSize);
+    writeValue<int32_t>(file, vfhConf.obstacleScanMode);
+    writeValue<double>(file, conf.mainHeadingWeight);
+    writeValue<double>(file, conf.distanceWeight);
+    writeValue<double>(file, conf.turningWeight);
+}
+
+void readCostConf(FILE *file, VFHStarConf &conf)
+{
+    VFHConf &vfhConf(conf.vfhConf);
+    int32_t intValue;
+    readValue(file, vfhConf.obstacleSafetyDistance);
+    readValue(file, vfhConf.robotWidth);
+    readValue(file, vfhConf.robotLength);
+    readValue(file, intValue);
+    vfhConf.footprintYawBins = intValue;
+    readValue(file, vfhConf.maxClearance);
+    vfhConf.sweptPathCheck = readBool(file);
+    readValue(file, vfhConf.sweptStepLength);
+    readValue(file, vfhConf.obstacleSenseRadius);
+    readValue(file, intValue);
+    vfhConf.narrowThreshold = intValue;
+    readValue(file, vfhConf.lowThreshold);
+    readValue(file, intValue);
+    vfhConf.histogramSize = intValue;
+    readValue(file, intValue);
+    vfhConf.obstacleScanMode = static_cast<ObstacleScanMode>(intValue);
+    readValue(file, conf.mainHeadingWeight);
+    readValue(file, conf.distanceWeight);
+    readValue(file, conf.turningWeight);
+}
+
+}
+
+bool isSameConfig(const TreeSearchConf& a, const TreeSearchConf& b)
+{
+    std::vector<uint8_t> bytesA, bytesB;
+    writeSearchConf(&bytesA, a);
+    writeSearchConf(&bytesB, b);
+    return bytesA == bytesB;
+}
+
+bool isSameConfig(const VFHStarConf& a, const VFHStarConf& b)
+{
+    std::vector<uint8_t> bytesA, bytesB;
+    writeCostConf(&bytesA, a);
+    writeCostConf(&bytesB, b);
+    return bytesA == bytesB;
+}
+
+PlanRecord::PlanRecord() : mainHeading(0), horizon(0), treeToWorld(Eigen::Affine3d::Identity()),
+    width(0), height(0), scale(0), offsetX(0), offsetY(0), obstacleClasses(256, true), treeSize(0), cost(-1)
+{
+}
+
+GridView PlanRecord::getGridView() const
+{
+    if(cells.empty())
+        return GridView();
+
+    GridView view(&cells[0], width, height, width, scale, offsetX, offsetY);
+    for(int i = 0; i < 256; i++)
+        view.setObstacleClass(i, obstacleClasses[i]);
+    return view;
+}
+
+void PlanRecord::setResult(const TreeNode* node, int treeSize)
+{
+    this->treeSize = treeSize;
+    cost = node ? node->getCost() : -1;
+    path.clear();
+    for(; node && !node->isRoot(); node = node->getParent())
+        path.insert(path.begin(), node->getPosition());
+}
+
+PlanCaptureWriter::PlanCaptureWriter(const std::string& fileName) : lastWidth(0), lastHeight(0)
+{
+    file = fopen(fileName.c_str(), "wb");
+    if(!file)
+        throw std::runtime_error("PlanCaptureWriter: Error, could not create " + fileName);
+
+    if(fwrite(fileMagic, 1, sizeof(fileMagic), file) != sizeof(fileMagic))
+    {
+        fclose(file);
+        throw std::runtime_error("PlanCaptureWriter: Error, could not write " + fileName);
+    }
+}
+
+PlanCaptureWriter::~PlanCaptureWriter()
+{
+    fclose(file);
+}
+
+void PlanCaptureWriter::write(const PlanRecord& record)
+{
+    if(record.cells.size() != static_cast<size_t>(record.width) * record.height)
+        throw std::runtime_error("PlanCaptureWriter::write: Error, cells do not match the size of the map");
+
+    writeVector(file, record.start.position);
+    writeValue<double>(file, record.start.orientation.w());
+    writeValue<double>(file, record.start.orientation.x());
+    writeValue<double>(file, record.start.orientation.y());
+    writeValue<double>(file, record.start.orientation.z());
+    writeValue<double>(file, record.mainHeading);
+    writeValue<double>(file, record.horizon);
+    for(int i = 0; i < 16; i++)
+        writeValue<double>(file, record.treeToWorld.matrix().data()[i]);
+    writeSearchConf(file, record.searchConf);
+    writeCostConf(file, record.costConf);
+
+    writeValue<int32_t>(file, record.width);
+    writeValue<int32_t>(file, record.height);
+    writeValue<double>(file, record.scale);
+    writeValue<double>(file, record.offsetX);
+    writeValue<double>(file, record.offsetY);
+    for(int i = 0; i < 256; i++)
+        writeBool(file, record.obstacleClasses[i]);
+
+    if(record.width != lastWidth || record.height != lastHeight)
+    {
+        writeValue<uint8_t>(file, MAP_FULL);
+        writeBytes(file, record.cells.empty() ? NULL : &record.cells[0], record.cells.size());
+    }
+    else
+    {
+        //collect the runs of changed cells
+        std::vector<std::pair<uint32_t, uint32_t> > runs;
+        const size_t size = record.cells.size();
+        size_t i = 0;
+        while(i < size)
+        {
+            if(record.cells[i] == lastCells[i])
+            {
+                i++;
+                continue;
+            }
+
+            const size_t start = i;
+            size_t end = i + 1;
+            size_t unchanged = 0;
+            for(i++; i < size && unchanged < runHeaderSize; i++)
+            {
+                if(record.cells[i] == lastCells[i])
+                {
+                    unchanged++;
+                }
+                else
+                {
+                    unchanged = 0;
+                    end = i + 1;
+                }
+            }
+            runs.push_back(std::make_pair(start, end - start));
+        }
+
+        writeValue<uint8_t>(file, MAP_DELTA);
+        writeValue<uint32_t>(file, runs.size());
+        for(std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = runs.begin(); it != runs.end(); it++)
+        {
+            writeValue<uint32_t>(file, it->first);
+            writeValue<uint32_t>(file, it->second);
+            writeBytes(file, &record.cells[it->first], it->second);
+        }
+    }
+    lastCells = record.cells;
+    lastWidth = record.width;
+    lastHeight = record.height;
+
+    writeTime(file, record.planningTime);
+    writeValue<int32_t>(file, record.treeSize);
+    writeValue<double>(file, record.cost);
+    writeValue<uint32_t>(file, record.path.size());
+    for(std::vector<base::Vector3d>::const_iterator it = record.path.begin(); it != record.path.end(); it++)
+        writeVector(file, *it);
+
+    if(fflush(file) != 0)
+        throw std::runtime_error("PlanCaptureWriter: Error, could not write to capture file");
+}
+
+PlanCaptureReader::PlanCaptureReader(const std::string& fileName) : lastWidth(0), lastHeight(0)
+{
+    file = fopen(fileName.c_str(), "rb");
+    if(!file)
+        throw std::runtime_error("PlanCaptureReader: Error, could not open " + fileName);
+
+    char magic[sizeof(fileMagic)];
+    if(fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, fileMagic, sizeof(fileMagic)) != 0)
+    {
+        fclose(file);
+        throw std::runtime_error("PlanCaptureReader: Error, " + fileName + " is not a capture file");
+    }
+}
+
+PlanCaptureReader::~PlanCaptureReader()
+{
+    fclose(file);
+}
+
+bool PlanCaptureReader::read(PlanRecord& record)
+{
+    //check for the end of the file before the first value
+    const int c = fgetc(file);
+    if(c == EOF)
+        return false;
+    ungetc(c, file);
+
+    readVector(file, record.start.position);
+    readValue(file, record.start.orientation.w());
+    readValue(file, record.start.orientation.x());
+    readValue(file, record.start.orientation.y());
+    readValue(file, record.start.orientation.z());
+    readValue(file, record.mainHeading);
+    readValue(file, record.horizon);
+    for(int i = 0; i < 16; i++)
+        readValue(file, record.treeToWorld.matrix().data()[i]);
+    readSearchConf(file, record.searchConf);
+    readCostConf(file, record.costConf);
+
+    int32_t width, height;
+    readValue(file, width);
+    readValue(file, height);
+    if(width < 0 || height < 0)
+        throw std::runtime_error("PlanCaptureReader: Error, capture file is corrupt");
+    record.width = width;
+    record.height = height;
+    readValue(file, record.scale);
+    readValue(file, record.offsetX);
+    readValue(file, record.offsetY);
+    record.obstacleClasses.resize(256);
+    for(int i = 0; i < 256; i++)
+        record.obstacleClasses[i] = readBool(file);
+
+    uint8_t encoding;
+    readValue(file, encoding);
+    if(encoding == MAP_FULL)
+    {
+        record.cells.resize(static_cast<size_t>(width) * height);
+        readBytes(file, record.cells.empty() ? NULL : &record.cells[0], record.cells.size());
+    }
+    else if(encoding == MAP_DELTA && width == lastWidth && height == lastHeight)
+    {
+        record.cells = lastCells;
+        uint32_t nrRuns;
+        readValue(file, nrRuns);
+        for(uint32_t i = 0; i < nrRuns; i++)
+        {
+            uint32_t start, length;
+            readValue(file, start);
+            readValue(file, length);
+            if(static_cast<size_t>(start) + length > record.cells.size())
+                throw std::runtime_error("PlanCaptureReader: Error, capture file is corrupt");
+            readBytes(file, &record.cells[start], length);
+        }
+    }
+    else
+    {
+        throw std::runtime_error("PlanCaptureReader: Error, capture file is corrupt");
+    }
+    lastCells = record.cells;
+    lastWidth = width;
+    lastHeight = height;
+
+    record.planningTime = readTime(file);
+    int32_t treeSize;
+    readValue(file, treeSize);
+    record.treeSize = treeSize;
+    readValue(file, record.cost);
+    uint32_t pathSize;
+    readValue(file, pathSize);
+    record.path.resize(pathSize);
+    for(std::vector<base::Vector3d>::iterator it = record.path.begin(); it != record.path.end(); it++)
+        readVector(file, *it);
+
+    return true;
+}
+
+}
@@ -0,0 +1,131 @@
+#ifndef PLANCAPTURE_HPP
+#define PLANCAPTURE_HPP
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <base/Pose.hpp>
+#include <base/Time.hpp>
+#include "GridView.hpp"
+#include "Types.h"
+
+namespace vfh_star {
+
+class TreeNode;
+
+/**
+ * Inputs and result of one call of VFHStar::computePath
+ * */
+struct PlanRecord
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    PlanRecord();
+
+    base::Pose start;
+    double mainHeading;
+    double horizon;
+    Eigen::Affine3d treeToWorld;
+    TreeSearchConf searchConf;
+    VFHStarConf costConf;
+
+    ///the map, row by row without padding
+    std::vector<uint8_t> cells;
+    int width;
+    int height;
+    double scale;
+    double offsetX;
+    double offsetY;
+    std::vector<bool> obstacleClasses;
+
+    ///time spent in computePath
+    base::Time planningTime;
+    ///number of nodes of the search tree
+    int treeSize;
+    ///cost of the chosen node, -1 if no path was found
+    double cost;
+    ///node positions from the root to the chosen node, in tree frame
+    std::vector<base::Vector3d> path;
+
+    /**
+     * Returns a view of the cells of the record. The
+     * record must outlive the view.
+     * */
+    GridView getGridView() const;
+
+    /**
+     * Sets the result of the record from the node returned by
+     * computePath and the tree it is part of
+     * */
+    void setResult(const TreeNode *node, int treeSize);
+};
+
+/**
+ * Returns true if the configurations agree in all
+ * fields that are stored in a capture
+ * */
+bool isSameConfig(const TreeSearchConf &a, const TreeSearchConf &b);
+bool isSameConfig(const VFHStarConf &a, const VFHStarConf &b);
+
+/**
+ * Appends plan records to a capture file.
+ *
+ * Consecutive plans mostly differ in a few cells of the map, so the
+ * map is stored as the runs of cells that changed since the previous
+ * record. It is stored completely for the first record and whenever
+ * the size of the map changed. Values are stored in host byte order.
+ * */
+class PlanCaptureWriter
+{
+public:
+    /**
+     * Creates the capture file. Throws if it can not be created.
+     * */
+    explicit PlanCaptureWriter(const std::string &fileName);
+    ~PlanCaptureWriter();
+
+    void write(const PlanRecord &record);
+
+private:
+    PlanCaptureWriter(const PlanCaptureWriter &);
+    PlanCaptureWriter &operator=(const PlanCaptureWriter &);
+
+    FILE *file;
+    std::vector<uint8_t> lastCells;
+    int lastWidth;
+    int lastHeight;
+};
+
+/**
+ * Reads the plan records of a capture file in order
+ * */
+class PlanCaptureReader
+{
+public:
+    /**
+     * Opens the capture file. Throws if it can not be
+     * opened or is not a capture file.
+     * */
+    explicit PlanCaptureReader(const std::string &fileName);
+    ~PlanCaptureReader();
+
+    /**
+     * Reads the next record. Returns false at the end of the
+     * file, throws if the file is truncated or corrupt.
+     * */
+    bool read(PlanRecord &record);
+
+private:
+    PlanCaptureReader(const PlanCaptureReader &);
+    PlanCaptureReader &operator=(const PlanCaptureReader &);
+
+    FILE *file;
+    std::vector<uint8_t> lastCells;
+    int lastWidth;
+    int lastHeight;
+};
+
+}
+
+#endif // PLANCAPTURE_HPP
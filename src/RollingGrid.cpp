@@ -0,0 +1,126 @@
+#include "RollingGrid.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace vfh_star {
+
+RollingGrid::RollingGrid(int width, int height, double scale, uint8_t unknownClass) :
+    width(width), height(height), scale(scale), unknownClass(unknownClass), originX(0), originY(0),
+    cells(width * height, unknownClass)
+{
+    if(width <= 0 || height <= 0 || scale <= 0)
+        throw std::runtime_error("RollingGrid: Error, size and scale must be greater than zero");
+
+    exposedAreas.push_back(CellArea(0, 0, width - 1, height - 1));
+}
+
+void RollingGrid::setTraversabilityClass(int classId, const envire::TraversabilityClass& trClass)
+{
+    if(classId < 0 || classId > 255)
+        throw std::runtime_error("RollingGrid::setTraversabilityClass: Error, class id out of range");
+
+    if(traversabilityClasses.size() <= static_cast<size_t>(classId))
+        traversabilityClasses.resize(classId + 1);
+
+    traversabilityClasses[classId] = trClass;
+}
+
+void RollingGrid::moveTo(const base::Vector3d& position)
+{
+    moveToCell(floor(position.x() / scale) - width / 2, floor(position.y() / scale) - height / 2);
+}
+
+void RollingGrid::moveToCell(int newOriginX, int newOriginY)
+{
+    const int dx = newOriginX - originX;
+    const int dy = newOriginY - originY;
+    if(!dx && !dy)
+        return;
+
+    originX = newOriginX;
+    originY = newOriginY;
+
+    //moved further than the window size, everything is new
+    if(abs(dx) >= width || abs(dy) >= height)
+    {
+        const CellArea all(originX, originY, originX + width - 1, originY + height - 1);
+        resetArea(all);
+        exposedAreas.push_back(all);
+        return;
+    }
+
+    //the exposed columns over the full height
+    if(dx)
+    {
+        const CellArea columns = dx > 0 ? CellArea(originX + width - dx, originY, originX + width - 1, originY + height - 1)
+                                        : CellArea(originX, originY, originX - dx - 1, originY + height - 1);
+        resetArea(columns);
+        exposedAreas.push_back(columns);
+    }
+
+    //the exposed rows, without the part covered by the columns
+    if(dy)
+    {
+        const int minX = dx > 0 ? originX : originX - dx;
+        const int maxX = dx > 0 ? originX + width - dx - 1 : originX + width - 1;
+        const CellArea rows = dy > 0 ? CellArea(minX, originY + height - dy, maxX, originY + height - 1)
+                                     : CellArea(minX, originY, maxX, originY - dy - 1);
+        if(!rows.isEmpty())
+        {
+            resetArea(rows);
+            exposedAreas.push_back(rows);
+        }
+    }
+}
+
+void RollingGrid::resetArea(const CellArea& area)
+{
+    for(int y = area.minY; y <= area.maxY; y++)
+    {
+        for(int x = area.minX; x <= area.maxX; x++)
+            cells[wrap(y, height) * width + wrap(x, width)] = unknownClass;
+    }
+}
+
+bool RollingGrid::toGrid(double x, double y, int& cellX, int& cellY) const
+{
+    cellX = floor(x / scale) - originX;
+    cellY = floor(y / scale) - originY;
+    return cellX >= 0 && cellY >= 0 && cellX < width && cellY < height;
+}
+
+void RollingGrid::setClass(int x, int y, uint8_t classId)
+{
+    cells[wrap(originY + y, height) * width + wrap(originX + x, width)] = classId;
+
+    const int gx = originX + x;
+    const int gy = originY + y;
+    if(changedArea.isEmpty())
+    {
+        changedArea = CellArea(gx, gy, gx, gy);
+        return;
+    }
+
+    changedArea.minX = std::min(changedArea.minX, gx);
+    changedArea.minY = std::min(changedArea.minY, gy);
+    changedArea.maxX = std::max(changedArea.maxX, gx);
+    changedArea.maxY = std::max(changedArea.maxY, gy);
+}
+
+std::vector<CellArea> RollingGrid::getChangedAreas() const
+{
+    std::vector<CellArea> areas(exposedAreas);
+    if(!changedArea.isEmpty())
+        areas.push_back(changedArea);
+
+    return areas;
+}
+
+void RollingGrid::clearChangedAreas()
+{
+    exposedAreas.clear();
+    changedArea = CellArea();
+}
+
+}
@@ -0,0 +1,164 @@
+#ifndef ROLLINGGRID_HPP
+#define ROLLINGGRID_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <base/Eigen.hpp>
+#include <envire/maps/TraversabilityGrid.hpp>
+
+namespace vfh_star {
+
+/**
+ * Rectangle of cells, both corners inclusive.
+ * */
+struct CellArea
+{
+    CellArea() : minX(0), minY(0), maxX(-1), maxY(-1) {}
+    CellArea(int minX, int minY, int maxX, int maxY) : minX(minX), minY(minY), maxX(maxX), maxY(maxY) {}
+
+    bool isEmpty() const
+    {
+        return maxX < minX || maxY < minY;
+    }
+
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+};
+
+/**
+ * Local traversability map, that follows the robot.
+ *
+ * The cells are stored in a ring buffer, which is indexed toroidally
+ * by the global cell coordinates. Moving the window therefore does not
+ * copy any cells, only the newly exposed rows and columns are reset
+ * to the unknown class.
+ *
+ * All cell accessors use window coordinates, i.e. (0, 0) is the cell
+ * at the lower left corner of the current window.
+ *
+ * Areas that were exposed by moving or changed by setClass are recorded
+ * in global cell coordinates, so that users of the grid can update
+ * their derived data. The areas are kept until clearChangedAreas is called.
+ * */
+class RollingGrid
+{
+public:
+    /**
+     * @param width number of cells in x
+     * @param height number of cells in y
+     * @param scale size of a cell in meters
+     * @param unknownClass class of the cells, that were not written yet
+     * */
+    RollingGrid(int width, int height, double scale, uint8_t unknownClass = 0);
+
+    void setTraversabilityClass(int classId, const envire::TraversabilityClass &trClass);
+
+    const std::vector<envire::TraversabilityClass> &getTraversabilityClasses() const
+    {
+        return traversabilityClasses;
+    }
+
+    /**
+     * Moves the window, so that the given position is
+     * located in its center cell
+     * */
+    void moveTo(const base::Vector3d &position);
+
+    /**
+     * Moves the window, so that its lower left corner
+     * is the global cell originX, originY
+     * */
+    void moveToCell(int originX, int originY);
+
+    /**
+     * Converts the position into window coordinates.
+     * Returns false if the position is outside of the window.
+     * */
+    bool toGrid(double x, double y, int &cellX, int &cellY) const;
+
+    uint8_t getClass(int x, int y) const
+    {
+        return cells[wrap(originY + y, height) * width + wrap(originX + x, width)];
+    }
+
+    void setClass(int x, int y, uint8_t classId);
+
+    int getWidth() const
+    {
+        return width;
+    }
+
+    int getHeight() const
+    {
+        return height;
+    }
+
+    double getScale() const
+    {
+        return scale;
+    }
+
+    /**
+     * Global cell coordinates of the lower left cell of the window
+     * */
+    int getOriginX() const
+    {
+        return originX;
+    }
+
+    int getOriginY() const
+    {
+        return originY;
+    }
+
+    /**
+     * Position of the lower left corner of the window in meters
+     * */
+    double getOffsetX() const
+    {
+        return originX * scale;
+    }
+
+    double getOffsetY() const
+    {
+        return originY * scale;
+    }
+
+    /**
+     * Returns the areas in global cell coordinates that
+     * changed since the last call to clearChangedAreas
+     * */
+    std::vector<CellArea> getChangedAreas() const;
+
+    void clearChangedAreas();
+
+private:
+    static int wrap(int v, int size)
+    {
+        const int r = v % size;
+        return r < 0 ? r + size : r;
+    }
+
+    void resetArea(const CellArea &area);
+
+    int width;
+    int height;
+    double scale;
+    uint8_t unknownClass;
+    int originX;
+    int originY;
+
+    std::vector<uint8_t> cells;
+    std::vector<envire::TraversabilityClass> traversabilityClasses;
+
+    ///areas exposed by moving the window
+    std::vector<CellArea> exposedAreas;
+    ///bounding box of the cells changed by setClass
+    CellArea changedArea;
+};
+
+}
+
+#endif // ROLLINGGRID_HPP
@@ -0,0 +1,182 @@
+#include "SweptStencils.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+namespace vfh_star {
+
+namespace {
+
+boost::mutex cacheMutex;
+
+///stencils handed out by SweptStencils::get
+std::vector<boost::weak_ptr<const SweptStencils> > cache;
+
+}
+
+SweptStencils::SweptStencils() : scale(0), radius(0), maxLength(0), directionBins(0), maxLengthCells(0), directionResolution(0)
+{
+}
+
+boost::shared_ptr<const SweptStencils> SweptStencils::get(double scale, double radius, int directionBins, double maxLength)
+{
+    boost::mutex::scoped_lock lock(cacheMutex);
+
+    std::vector<boost::weak_ptr<const SweptStencils> >::iterator it = cache.begin();
+    while(it != cache.end())
+    {
+        boost::shared_ptr<const SweptStencils> stencils(it->lock());
+        if(!stencils)
+        {
+            it = cache.erase(it);
+            continue;
+        }
+        if(stencils->isComputedFor(scale, radius, directionBins, maxLength))
+            return stencils;
+        it++;
+    }
+
+    boost::shared_ptr<SweptStencils> stencils(new SweptStencils());
+    stencils->compute(scale, radius, directionBins, maxLength);
+    cache.push_back(stencils);
+    return stencils;
+}
+
+bool SweptStencils::isComputedFor(double scale, double radius, int directionBins, double maxLength) const
+{
+    return !isEmpty() && this->scale == scale && this->radius == radius
+        && this->directionBins == directionBins && this->maxLength == maxLength;
+}
+
+bool SweptStencils::isEmpty() const
+{
+    return stencilStart.empty();
+}
+
+void SweptStencils::swap(SweptStencils& other)
+{
+    std::swap(scale, other.scale);
+    std::swap(radius, other.radius);
+    std::swap(maxLength, other.maxLength);
+    std::swap(directionBins, other.directionBins);
+    std::swap(maxLengthCells, other.maxLengthCells);
+    std::swap(directionResolution, other.directionResolution);
+    stencilStart.swap(other.stencilStart);
+    spans.swap(other.spans);
+}
+
+void SweptStencils::clear()
+{
+    stencilStart.clear();
+    spans.clear();
+}
+
+void SweptStencils::compute(double scale, double radius, int directionBins, double maxLength)
+{
+    if(directionBins <= 0)
+        throw std::runtime_error("SweptStencils::compute: Error, directionBins must be greater than zero");
+
+    this->scale = scale;
+    this->radius = radius;
+    this->maxLength = maxLength;
+    this->directionBins = directionBins;
+    directionResolution = 2 * M_PI / directionBins;
+    maxLengthCells = std::max(1, static_cast<int>(ceil(maxLength / scale)));
+
+    stencilStart.clear();
+    spans.clear();
+    stencilStart.reserve((maxLengthCells + 1) * directionBins + 1);
+
+    //there are no stencils of length zero
+    stencilStart.resize(directionBins, 0);
+
+    const double radiusCells = radius / scale;
+    for(int length = 1; length <= maxLengthCells; length++)
+    {
+        //the real direction differs up to half a bin from the direction
+        //of the stencil, the start position is rounded to a cell
+        //and the distance is measured to the center of the obstacle
+        //cell. Grow the disc, so that the stencil is conservative
+        const double r = radiusCells + length * sin(directionResolution / 2.0) + 2 * M_SQRT1_2;
+        const int bound = ceil(r + length);
+        for(int bin = 0; bin < directionBins; bin++)
+        {
+            stencilStart.push_back(spans.size());
+
+            const double ex = cos(bin * directionResolution) * length;
+            const double ey = sin(bin * directionResolution) * length;
+            for(int y = -bound; y <= bound; y++)
+            {
+                Span span;
+                span.y = y;
+                span.xStart = bound + 1;
+                span.xEnd = -bound - 1;
+                for(int x = -bound; x <= bound; x++)
+                {
+                    //distance of the cell center to the segment
+                    double t = (x * ex + y * ey) / (length * length);
+                    t = std::max(0.0, std::min(1.0, t));
+                    const double distX = x - t * ex;
+                    const double distY = y - t * ey;
+                    if(distX * distX + distY * distY > r * r)
+                        continue;
+
+                    span.xStart = std::min<int>(span.xStart, x);
+                    span.xEnd = std::max<int>(span.xEnd, x);
+                }
+                if(span.xStart <= span.xEnd)
+                    spans.push_back(span);
+            }
+        }
+    }
+    stencilStart.push_back(spans.size());
+}
+
+bool SweptStencils::isStencilFree(const ObstacleBitmap& obstacles, int x, int y, int directionBin, int length) const
+{
+    const int idx = length * directionBins + directionBin;
+    const int end = stencilStart[idx + 1];
+    for(int i = stencilStart[idx]; i < end; i++)
+    {
+        const Span &span(spans[i]);
+        if(obstacles.hasObstacleInSpan(y + span.y, x + span.xStart, x + span.xEnd))
+            return false;
+    }
+    return true;
+}
+
+bool SweptStencils::isSegmentFree(const ObstacleBitmap& obstacles, double startX, double startY, double endX, double endY) const
+{
+    const double dx = endX - startX;
+    const double dy = endY - startY;
+    const double dist = sqrt(dx * dx + dy * dy);
+
+    int bin = floor(atan2(dy, dx) / directionResolution + 0.5);
+    if(bin < 0)
+        bin += directionBins;
+    if(bin >= directionBins)
+        bin -= directionBins;
+
+    int remaining = std::max(1, static_cast<int>(ceil(dist)));
+    double x = startX;
+    double y = startY;
+    while(remaining > 0)
+    {
+        const int length = std::min(remaining, maxLengthCells);
+        if(!isStencilFree(obstacles, floor(x), floor(y), bin, length))
+            return false;
+
+        remaining -= length;
+        if(dist > 0)
+        {
+            x += dx / dist * length;
+            y += dy / dist * length;
+        }
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,87 @@
+#ifndef SWEPTSTENCILS_HPP
+#define SWEPTSTENCILS_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "ObstacleBitmap.hpp"
+
+namespace vfh_star {
+
+/**
+ * Precomputed cell stencils of the area swept by the robot disc,
+ * while moving along a straight segment.
+ *
+ * There is one stencil per (direction bin, segment length in cells).
+ * As the swept disc is convex, a stencil is stored as one span of
+ * cells per row, which can be tested against an ObstacleBitmap
+ * word wise.
+ *
+ * The stencils only depend on the parameters of compute, not on the
+ * map. Use get to share them between all maps with the same parameters.
+ * */
+class SweptStencils
+{
+public:
+    struct Span
+    {
+        int16_t y;
+        int16_t xStart;
+        int16_t xEnd;
+    };
+
+    SweptStencils();
+
+    /**
+     * Computes the stencils.
+     *
+     * @param scale size of a grid cell in meters
+     * @param radius radius of the robot disc in meters
+     * @param directionBins number of direction bins over 2 PI
+     * @param maxLength maximum segment length in meters, longer segments are split
+     * */
+    void compute(double scale, double radius, int directionBins, double maxLength);
+
+    /**
+     * Returns stencils computed with the given parameters. Stencils
+     * that are still in use somewhere are shared instead of computed
+     * again. This is thread safe.
+     * */
+    static boost::shared_ptr<const SweptStencils> get(double scale, double radius, int directionBins, double maxLength);
+
+    /**
+     * Returns true if the stencils were computed with the given parameters
+     * */
+    bool isComputedFor(double scale, double radius, int directionBins, double maxLength) const;
+
+    bool isEmpty() const;
+
+    void clear();
+
+    void swap(SweptStencils &other);
+
+    /**
+     * Returns true if the robot can move from the start to the end
+     * position without touching an obstacle in the bitmap.
+     * Positions are given in grid coordinates, measured in cells.
+     * */
+    bool isSegmentFree(const ObstacleBitmap &obstacles, double startX, double startY, double endX, double endY) const;
+
+private:
+    bool isStencilFree(const ObstacleBitmap &obstacles, int x, int y, int directionBin, int length) const;
+
+    double scale;
+    double radius;
+    double maxLength;
+    int directionBins;
+    int maxLengthCells;
+    double directionResolution;
+
+    ///index of the first span of a stencil, indexed by length * directionBins + directionBin
+    std::vector<int> stencilStart;
+    std::vector<Span> spans;
+};
+
+}
+
+#endif // SWEPTSTENCILS_HPP
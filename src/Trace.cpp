@@ -0,0 +1,227 @@
+#include "Trace.hpp"
+#include <time.h>
+#include <cstdio>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <pthread.h>
+#include <boost/thread/mutex.hpp>
+
+namespace vfh_star {
+
+namespace {
+
+struct TraceEvent
+{
+    const char *name;
+    uint64_t begin;
+    ///end of a span, value of a counter
+    int64_t endOrValue;
+    bool isCounter;
+};
+
+/**
+ * Events of one thread. Only the owning thread writes, it publishes
+ * an event by increasing count after writing it. The events are
+ * allocated with the first event, under the registry lock.
+ * */
+struct ThreadBuffer
+{
+    std::vector<TraceEvent> events;
+    volatile size_t count;
+    volatile size_t dropped;
+    int threadId;
+    ///the thread ended, the buffer is only kept for its events
+    bool finished;
+};
+
+boost::mutex registryMutex;
+std::vector<ThreadBuffer *> buffers;
+size_t threadBufferSize = 1 << 18;
+int nextThreadId = 1;
+
+__thread ThreadBuffer *threadBuffer = NULL;
+
+pthread_key_t threadExitKey;
+pthread_once_t threadExitKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Called when a thread with a buffer ends. The events are kept until
+ * they are written or cleared, but not the unused rest of the buffer.
+ * */
+void releaseThreadBuffer(void *data)
+{
+    ThreadBuffer *buffer = static_cast<ThreadBuffer *>(data);
+    boost::mutex::scoped_lock lock(registryMutex);
+    if(buffer->count)
+    {
+        std::vector<TraceEvent>(buffer->events.begin(), buffer->events.begin() + buffer->count).swap(buffer->events);
+        buffer->finished = true;
+        return;
+    }
+
+    buffers.erase(std::find(buffers.begin(), buffers.end(), buffer));
+    delete buffer;
+}
+
+void createThreadExitKey()
+{
+    pthread_key_create(&threadExitKey, &releaseThreadBuffer);
+}
+
+ThreadBuffer *getThreadBuffer()
+{
+    if(!threadBuffer)
+    {
+        pthread_once(&threadExitKeyOnce, &createThreadExitKey);
+        boost::mutex::scoped_lock lock(registryMutex);
+        ThreadBuffer *buffer = new ThreadBuffer();
+        buffer->count = 0;
+        buffer->dropped = 0;
+        buffer->threadId = nextThreadId++;
+        buffer->finished = false;
+        buffers.push_back(buffer);
+        pthread_setspecific(threadExitKey, buffer);
+        threadBuffer = buffer;
+    }
+
+    //the events are freed by clear
+    if(threadBuffer->events.empty())
+    {
+        boost::mutex::scoped_lock lock(registryMutex);
+        threadBuffer->events.resize(threadBufferSize);
+    }
+    return threadBuffer;
+}
+
+void addEvent(const char *name, uint64_t begin, int64_t endOrValue, bool isCounter)
+{
+    ThreadBuffer *buffer = getThreadBuffer();
+    const size_t count = buffer->count;
+    if(count == buffer->events.size())
+    {
+        buffer->dropped = buffer->dropped + 1;
+        return;
+    }
+
+    TraceEvent &event(buffer->events[count]);
+    event.name = name;
+    event.begin = begin;
+    event.endOrValue = endOrValue;
+    event.isCounter = isCounter;
+
+    //the event must be complete before it is published
+    __sync_synchronize();
+    buffer->count = count + 1;
+}
+
+}
+
+volatile int Trace::currentLevel = Trace::OFF;
+
+void Trace::start(Trace::Level level, size_t bufferSize)
+{
+    {
+        boost::mutex::scoped_lock lock(registryMutex);
+        threadBufferSize = std::max<size_t>(1, bufferSize);
+    }
+    currentLevel = level;
+}
+
+void Trace::stop()
+{
+    currentLevel = OFF;
+}
+
+void Trace::clear()
+{
+    boost::mutex::scoped_lock lock(registryMutex);
+    std::vector<ThreadBuffer *> running;
+    for(std::vector<ThreadBuffer *>::iterator it = buffers.begin(); it != buffers.end(); it++)
+    {
+        if((*it)->finished)
+        {
+            delete *it;
+            continue;
+        }
+
+        //the thread allocates its events again with its next event
+        std::vector<TraceEvent>().swap((*it)->events);
+        (*it)->count = 0;
+        (*it)->dropped = 0;
+        running.push_back(*it);
+    }
+    buffers.swap(running);
+}
+
+size_t Trace::getDroppedEvents()
+{
+    boost::mutex::scoped_lock lock(registryMutex);
+    size_t dropped = 0;
+    for(std::vector<ThreadBuffer *>::const_iterator it = buffers.begin(); it != buffers.end(); it++)
+        dropped += (*it)->dropped;
+    return dropped;
+}
+
+uint64_t Trace::now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+void Trace::addSpan(const char* name, uint64_t begin, uint64_t end)
+{
+    addEvent(name, begin, end, false);
+}
+
+void Trace::addCounter(const char* name, int64_t value)
+{
+    if(isEnabled(CYCLES))
+        addEvent(name, now(), value, true);
+}
+
+void Trace::writeChromeTrace(const std::string& fileName)
+{
+    FILE *file = fopen(fileName.c_str(), "w");
+    if(!file)
+        throw std::runtime_error("Trace: could not create " + fileName);
+
+    boost::mutex::scoped_lock lock(registryMutex);
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for(std::vector<ThreadBuffer *>::const_iterator it = buffers.begin(); it != buffers.end(); it++)
+    {
+        const ThreadBuffer &buffer(**it);
+        const size_t count = buffer.count;
+        __sync_synchronize();
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                first ? "" : ",\n", buffer.threadId, buffer.threadId);
+        first = false;
+
+        for(size_t i = 0; i < count; i++)
+        {
+            const TraceEvent &event(buffer.events[i]);
+            if(event.isCounter)
+            {
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%llu,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%lld}}",
+                        event.name, static_cast<unsigned long long>(event.begin), buffer.threadId,
+                        static_cast<long long>(event.endOrValue));
+            }
+            else
+            {
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"vfh_star\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%d}",
+                        event.name, static_cast<unsigned long long>(event.begin),
+                        static_cast<unsigned long long>(event.endOrValue - event.begin), buffer.threadId);
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    const bool failed = ferror(file);
+    if(fclose(file) || failed)
+        throw std::runtime_error("Trace: could not write " + fileName);
+}
+
+}
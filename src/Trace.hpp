@@ -0,0 +1,134 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <stdint.h>
+#include <string>
+
+namespace vfh_star {
+
+/**
+ * Timeline of the planner, exported as Chrome trace JSON, which can be
+ * opened in chrome://tracing or the Perfetto UI.
+ *
+ * The planner records spans for map updates, path computation, the
+ * phases of the search and trajectory building. Every thread writes
+ * into its own fixed size buffer without locking. Only the first
+ * event of a thread takes a lock, to allocate its buffer. Events that
+ * do not fit into the buffer are dropped and counted. When a thread
+ * ends, its buffer is shrunk to its events, or freed if it has none.
+ *
+ * Tracing is off by default and costs a check of a global flag per
+ * span while off.
+ * */
+class Trace
+{
+public:
+    enum Level
+    {
+        ///no events are recorded
+        OFF = 0,
+        ///map updates, path computations and trajectory building
+        CYCLES = 1,
+        ///additionally the phases of every node expansion
+        EXPANSIONS = 2
+    };
+
+    /**
+     * Starts recording events of the given level and below.
+     * Events are appended to the ones already recorded.
+     *
+     * Each thread allocates a buffer for bufferSize events with its
+     * first event. The default of 2^18 events takes 8 MB. Buffers
+     * allocated before keep their size until clear is called.
+     * */
+    static void start(Level level = CYCLES, size_t bufferSize = 1 << 18);
+
+    /**
+     * Stops recording events
+     * */
+    static void stop();
+
+    /**
+     * Removes all recorded events and frees the buffers of all
+     * threads. Must only be called while stopped and while no
+     * span is open.
+     * */
+    static void clear();
+
+    /**
+     * Writes all recorded events as Chrome trace JSON. Must only be
+     * called while stopped and while no span is open. Throws if the
+     * file can not be written.
+     * */
+    static void writeChromeTrace(const std::string &fileName);
+
+    /**
+     * Returns the number of events that were dropped, because the
+     * buffer of their thread was full
+     * */
+    static size_t getDroppedEvents();
+
+    static bool isEnabled(Level level)
+    {
+        return level <= currentLevel;
+    }
+
+    /**
+     * Microseconds of a monotonic clock
+     * */
+    static uint64_t now();
+
+    /**
+     * Records a span of the calling thread. The name must
+     * be a string literal, only the pointer is stored.
+     * */
+    static void addSpan(const char *name, uint64_t begin, uint64_t end);
+
+    /**
+     * Records the value of a counter, shown as graph over time
+     * */
+    static void addCounter(const char *name, int64_t value);
+
+private:
+    static volatile int currentLevel;
+};
+
+/**
+ * Records a span from its construction to its destruction or the call
+ * of end(), if tracing of the given level is enabled on construction.
+ * The name must be a string literal.
+ * */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name, Trace::Level level = Trace::CYCLES) : name(name), begin(0)
+    {
+        if(Trace::isEnabled(level))
+            begin = Trace::now();
+    }
+
+    ~TraceSpan()
+    {
+        end();
+    }
+
+    void end()
+    {
+        if(begin)
+        {
+            Trace::addSpan(name, begin, Trace::now());
+            begin = 0;
+        }
+    }
+
+private:
+    TraceSpan(const TraceSpan &);
+    TraceSpan &operator=(const TraceSpan &);
+
+    const char *name;
+    uint64_t begin;
+};
+
+}
+
+#endif // TRACE_HPP
@@ -33,7 +33,7 @@ void Tree::reserve(int size)
         nodes.push_back(TreeNode());
 }
 
-TreeNode* Tree::createNode(base::Pose const& pose, const base::Angle &dir)
+TreeNode* Tree::createNode(base::Pose const& pose, const BinaryAngle &dir)
 {
     TreeNode* n;
     if (!free_nodes.empty())
@@ -58,8 +58,7 @@ TreeNode* Tree::createNode(base::Pose const& pose, const base::Angle &dir)
     }
 
     n->clear();
-    n->pose = pose;
-    n->yaw = base::Angle::fromRad(pose.getYaw());
+    n->setPose(pose);
     n->direction = dir;
     n->index  = size;
     if(debugTree)
@@ -71,7 +70,7 @@ TreeNode* Tree::createNode(base::Pose const& pose, const base::Angle &dir)
     return n;
 }
 
-TreeNode* Tree::createRoot(base::Pose const& pose, const base::Angle &dir)
+TreeNode* Tree::createRoot(base::Pose const& pose, const BinaryAngle &dir)
 {
     if (root_node)
         throw std::runtime_error("trying to create a root node of an non-empty tree");
@@ -81,7 +80,7 @@ TreeNode* Tree::createRoot(base::Pose const& pose, const base::Angle &dir)
     return root_node;
 }
 
-TreeNode* Tree::createChild(TreeNode* parent, base::Pose const& pose, const base::Angle &dir)
+TreeNode* Tree::createChild(TreeNode* parent, base::Pose const& pose, const BinaryAngle &dir)
 {
     TreeNode* child = createNode(pose, dir);
     child->depth  = parent->depth + 1;
@@ -20,9 +20,9 @@ class Tree
         Tree(Tree const& other);
         Tree& operator = (Tree const& other);
         
-        TreeNode* createRoot(const base::Pose& pose, const base::Angle& dir);
-        TreeNode* createNode(const base::Pose& pose, const base::Angle& dir);
-        TreeNode* createChild(TreeNode* parent, const base::Pose& pose, const base::Angle& dir);
+        TreeNode* createRoot(const base::Pose& pose, const BinaryAngle& dir);
+        TreeNode* createNode(const base::Pose& pose, const BinaryAngle& dir);
+        TreeNode* createChild(TreeNode* parent, const base::Pose& pose, const BinaryAngle& dir);
 
         TreeNode *getParent(TreeNode *child);
         const TreeNode *getRootNode() const;
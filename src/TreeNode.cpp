@@ -8,40 +8,43 @@ TreeNode::TreeNode()
 }
 
 TreeNode::TreeNode(const base::Pose& pose, const base::Angle& dir, const DriveMode* driveMode, uint8_t driveModeNr)
-    : parent(this)
-    , is_leaf(true)
-    , pose(pose)
-    , yaw(base::Angle::fromRad(pose.getYaw()))
-    , direction(dir)
-    , cost(0)
-    , heuristic(0)
-    , costFromParent(0)
-    , driveMode(driveMode)
-    , driveModeNr(driveModeNr)
-    , depth(0)
-    , index(0)
-    , updated_cost(false)
-    , positionTolerance(0)
-    , headingTolerance(0)
 {
     clear();
+    init(pose, BinaryAngle::fromAngle(dir), driveMode, driveModeNr);
+}
+
+TreeNode::TreeNode(const base::Pose& pose, const BinaryAngle& dir, const DriveMode* driveMode, uint8_t driveModeNr)
+{
+    clear();
+    init(pose, dir, driveMode, driveModeNr);
+}
+
+void TreeNode::init(const base::Pose& pose, const BinaryAngle& dir, const DriveMode* driveMode, uint8_t driveModeNr)
+{
     direction = dir;
-    this->pose = pose;
-//     yaw = pose.getYaw();
+    setPose(pose);
     this->driveMode=driveMode;
     this->driveModeNr=driveModeNr;
-    yaw = base::Angle::fromRad(pose.getYaw());
+}
+
+void TreeNode::setPose(const base::Pose& pose)
+{
+    position = pose.position.cast<Scalar>();
+    orientation = pose.orientation.cast<Scalar>();
+    yaw = BinaryAngle::fromRad(pose.getYaw());
 }
 
 void TreeNode::clear()
 {
     parent = this;
-    pose = base::Pose();
-    yaw = base::Angle();
+    position.setZero();
+    orientation.setIdentity();
+    yaw = BinaryAngle();
     is_leaf = true;
     cost = 0;
     heuristic = 0;
     costFromParent = 0;
+    pathLength = 0;
     driveMode = 0;
     driveModeNr = std::numeric_limits<uint8_t>::max();
     depth = 0;
@@ -49,16 +52,21 @@ void TreeNode::clear()
     updated_cost = false;
     positionTolerance = 0;
     headingTolerance = 0;
-    direction = base::Angle();
+    direction = BinaryAngle();
     childs.clear();
 }
 
-const base::Vector3d &TreeNode::getPosition() const
+base::Vector3d TreeNode::getPosition() const
+{
+    return position.cast<double>();
+}
+
+base::Angle TreeNode::getYaw() const
 {
-    return pose.position;
+    return yaw.toAngle();
 }
 
-const base::Angle &TreeNode::getYaw() const
+const BinaryAngle &TreeNode::getBinaryYaw() const
 {
     return yaw;
 }
@@ -118,6 +126,16 @@ double TreeNode::getCostFromParent() const
     return costFromParent;
 }
 
+double TreeNode::getPathLength() const
+{
+    return pathLength;
+}
+
+void TreeNode::setPathLength(double value)
+{
+    pathLength = value;
+}
+
 void TreeNode::addChild(TreeNode* child)
 {
     is_leaf = false;
@@ -146,8 +164,11 @@ const TreeNode* TreeNode::getParent() const
     return parent;
 }
 
-const base::Pose& TreeNode::getPose() const
+base::Pose TreeNode::getPose() const
 {
+    base::Pose pose;
+    pose.position = position.cast<double>();
+    pose.orientation = orientation.cast<double>();
     return pose;
 }
 
@@ -166,7 +187,12 @@ bool TreeNode::isLeaf() const
     return is_leaf;
 }
 
-const base::Angle &TreeNode::getDirection() const
+base::Angle TreeNode::getDirection() const
+{
+    return direction.toAngle();
+}
+
+const BinaryAngle &TreeNode::getBinaryDirection() const
 {
     return direction;
 }
@@ -3,6 +3,8 @@
 
 #include <base/Pose.hpp>
 #include "DriveMode.hpp"
+#include "Types.h"
+#include "BinaryAngle.hpp"
 #include <map>
 
 namespace vfh_star {
@@ -16,24 +18,31 @@ class TreeNode
 
         TreeNode();
         TreeNode(const base::Pose &pose, const base::Angle &dir, DriveMode const *driveMode, uint8_t driveModeNr);
+        TreeNode(const base::Pose &pose, const BinaryAngle &dir, DriveMode const *driveMode, uint8_t driveModeNr);
         
         void clear();
 
         bool isRoot() const;
         bool isLeaf() const;
         
-        const base::Pose &getPose() const;
+        /**
+         * The pose is stored with Scalar precision and
+         * converted to double on access
+         * */
+        base::Pose getPose() const;
         const TreeNode *getParent() const;
         
         void addChild(TreeNode *child);
         void removeChild(TreeNode *child);
         const std::vector<TreeNode *> &getChildren() const;
         
-        const base::Angle &getDirection() const;
+        base::Angle getDirection() const;
+        const BinaryAngle &getBinaryDirection() const;
         int getDepth() const;
 
-        const base::Angle &getYaw() const;
-        const base::Vector3d &getPosition() const;
+        base::Angle getYaw() const;
+        const BinaryAngle &getBinaryYaw() const;
+        base::Vector3d getPosition() const;
         
         int getIndex() const;
 
@@ -52,51 +61,70 @@ class TreeNode
         void setCostFromParent(double value);
         double getCostFromParent() const;
         
+        /**
+         * Distance travelled from the root to this node,
+         * as the sum of the step distances
+         * */
+        double getPathLength() const;
+        void setPathLength(double value);
+        
         double getPositionTolerance() const;
         void setPositionTolerance(double tol);
         double getHeadingTolerance() const;
         void setHeadingTolerance(double tol);
         
     private:
+        void init(const base::Pose &pose, const BinaryAngle &dir, DriveMode const *driveMode, uint8_t driveModeNr);
+        void setPose(const base::Pose &pose);
+
+        // The members are ordered by size to keep the padding small
+
         TreeNode *parent;
-        bool is_leaf;
         
-        ///pose of the node, note the orientation of the node and the direction may differ, 
+        ///the drive mode that was used to get to the current position
+        DriveMode const *driveMode;
+
+        std::vector<TreeNode *> childs;
+        
+        // Used by TreeSearch only, a TreeSearch::OpenList::iterator
+        mutable std::multimap<Scalar, TreeNode *>::iterator candidate_it;
+        
+        ///orientation of the node, note the orientation of the node and the direction may differ, 
         ///because of kinematic constrains of the robot
-        base::Pose pose;
+        Eigen::Quaternion<Scalar> orientation;
+
+        ///position of the node
+        Eigen::Matrix<Scalar, 3, 1> position;
 
         ///yaw of the pose
-        base::Angle yaw;
+        BinaryAngle yaw;
         
         ///direction, that was choosen, that lead to this node
-        base::Angle direction;
+        BinaryAngle direction;
         
         ///cost from start to this node
-        double cost;
+        Scalar cost;
         
         ///heuristic from node to goal
-        double heuristic;
+        Scalar heuristic;
         
         ///cost from parent to this node
-        double costFromParent;
+        Scalar costFromParent;
         
-        ///the drive mode that was used to get to the current position
-        DriveMode const *driveMode;
+        ///sum of the step distances from the root to this node
+        Scalar pathLength;
+
+        float positionTolerance;
+        float headingTolerance;
+        
+        int depth;
+        int index;
         
         ///Nr used to reference the drive mode in the tree.
         uint8_t driveModeNr;
         
-        int depth;
-        int index;
+        bool is_leaf;
         bool updated_cost;
-
-        float positionTolerance;
-        float headingTolerance;
-
-        std::vector<TreeNode *> childs;
-        
-        // Used by TreeSearch only
-        mutable std::multimap<double, TreeNode *>::iterator candidate_it;
 };
 
 }
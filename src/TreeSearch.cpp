@@ -1,6 +1,9 @@
 #include "TreeSearch.h"
+#include "Trace.hpp"
 #include <Eigen/Core>
 #include <map>
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 #include <iostream>
 #include <base/Angle.hpp>
@@ -9,6 +12,9 @@
 namespace vfh_star {
 
 bool printDebug = false;
+
+/** Number of sampling density levels the sample tables are compiled for */
+static const int samplingDensityLevels = 5;
             
 void TreeSearchConf::computePosAndYawThreshold()
 {
@@ -22,9 +28,31 @@ void TreeSearchConf::computePosAndYawThreshold()
         identityYawThreshold = 3.0 * 180.0 / M_PI;
     }
 
+    std::sort(resolutionSchedule.begin(), resolutionSchedule.end(), lowerStartDistance);
+    for(std::vector<SearchResolution>::iterator it = resolutionSchedule.begin(); it != resolutionSchedule.end(); it++)
+    {
+        if(it->identityPositionThreshold < 0)
+            it->identityPositionThreshold = it->stepDistance / 5.0;
+        
+        if(it->identityYawThreshold < 0)
+            it->identityYawThreshold = identityYawThreshold;
+    }
+}
+
+double TreeSearchConf::getMaxStepDistance() const
+{
+    double step = std::max(stepDistance, maxStepDistance);
+    for(std::vector<SearchResolution>::const_iterator it = resolutionSchedule.begin(); it != resolutionSchedule.end(); it++)
+        step = std::max(step, it->stepDistance);
+    return step;
+}
+
+bool TreeSearchConf::lowerStartDistance(const SearchResolution& a, const SearchResolution& b)
+{
+    return a.startDistance < b.startDistance;
 }
     
-TreeSearch::TreeSearch(): tree2World(Eigen::Affine3d::Identity()), nnLookup(NULL)
+TreeSearch::TreeSearch(): tree2World(Eigen::Affine3d::Identity()), startPosition(0, 0, 0)
 {
     search_conf.computePosAndYawThreshold();
 }
@@ -42,21 +70,44 @@ const Eigen::Affine3d& TreeSearch::getTreeToWorld() const
 
 TreeSearch::~TreeSearch()
 {
-    delete nnLookup;
+    configChanged();
 }
 
 void TreeSearch::configChanged()
 {
    //trigger update of nearest neighbour lookup 
     //will be reconstructed on next search
-    delete nnLookup;
-    nnLookup = 0;
+    for(std::vector<NNLookup *>::iterator it = nnLookups.begin(); it != nnLookups.end(); it++)
+        delete *it;
+    nnLookups.clear();
+    
+    //the drive mode transitions are compiled on the next search
+    allowedDriveModes.clear();
 }
 
 void TreeSearch::setSearchConf(const TreeSearchConf& conf)
 {
     this->search_conf = conf;
     search_conf.computePosAndYawThreshold();
+    budgetController.setConfig(search_conf.budgetControl, search_conf.maxTreeSize);
+
+    sampleTables.clear();
+    if(search_conf.directionBins > 0)
+    {
+        const bool adaptive = search_conf.samplingDensityMin != search_conf.samplingDensityMax;
+        sampleTables.resize(search_conf.resolutionSchedule.size() + 1);
+        for(size_t r = 0; r < sampleTables.size(); r++)
+        {
+            const double resolutionScale = getResolutionSamplingScale(r);
+            sampleTables[r].resize(adaptive ? samplingDensityLevels : 1);
+            for(size_t i = 0; i < sampleTables[r].size(); i++)
+            {
+                const double level = adaptive ? static_cast<double>(i) / (samplingDensityLevels - 1) : 0.0;
+                const double density = search_conf.samplingDensityMin + level * (search_conf.samplingDensityMax - search_conf.samplingDensityMin);
+                sampleTables[r][i].compile(search_conf.sampleAreas, search_conf.directionBins, density * resolutionScale);
+            }
+        }
+    }
 
     configChanged();
  }
@@ -78,8 +129,8 @@ void TreeSearch::addDirections(TreeSearch::Angles& directions, const base::Angle
         step = maxStep;
 
     int intervalSize = ceil(intervalOpening / step);
-    base::Angle delta = base::Angle::fromRad(intervalOpening / intervalSize);
-    base::Angle result = segment.getStart();
+    const BinaryAngle delta = BinaryAngle::fromRad(intervalOpening / intervalSize);
+    BinaryAngle result = BinaryAngle::fromAngle(segment.getStart());
     for (int i = 0; i < intervalSize + 1; ++i)
     {
         directions.push_back(result);
@@ -88,9 +139,107 @@ void TreeSearch::addDirections(TreeSearch::Angles& directions, const base::Angle
 }
 
 
-TreeSearch::Angles TreeSearch::getDirectionsFromIntervals(const base::Angle &curDir, const TreeSearch::AngleIntervals& intervals)
+double TreeSearch::getClearance(const TreeNode& node) const
+{
+    return -1;
+}
+
+double TreeSearch::getRobotRadius() const
+{
+    return 0;
+}
+
+double TreeSearch::getSamplingDensityScale(double clearance) const
+{
+    if(clearance < 0 || search_conf.samplingDensityMin == search_conf.samplingDensityMax)
+        return 1.0;
+    
+    double t = 0;
+    if(search_conf.clearanceSamplingFar > search_conf.clearanceSamplingNear)
+        t = (clearance - search_conf.clearanceSamplingNear) / (search_conf.clearanceSamplingFar - search_conf.clearanceSamplingNear);
+    else
+        t = clearance < search_conf.clearanceSamplingNear ? 0.0 : 1.0;
+    t = std::max(0.0, std::min(1.0, t));
+    
+    return search_conf.samplingDensityMax + t * (search_conf.samplingDensityMin - search_conf.samplingDensityMax);
+}
+
+int TreeSearch::getResolutionLevel(const base::Vector3d& position) const
+{
+    const std::vector<SearchResolution> &schedule(search_conf.resolutionSchedule);
+    if(schedule.empty())
+        return 0;
+    
+    const double distance = (position - startPosition).norm();
+    int level = 0;
+    while(level < static_cast<int>(schedule.size()) && schedule[level].startDistance <= distance)
+        level++;
+    
+    return level;
+}
+
+double TreeSearch::getResolutionStepDistance(int level) const
+{
+    if(level == 0)
+        return search_conf.stepDistance;
+    return search_conf.resolutionSchedule[level - 1].stepDistance;
+}
+
+double TreeSearch::getResolutionSamplingScale(int level) const
+{
+    if(level == 0)
+        return 1.0;
+    return search_conf.resolutionSchedule[level - 1].angularSamplingScale;
+}
+
+bool TreeSearch::hasVariableStepDistance() const
+{
+    return search_conf.maxStepDistance > search_conf.stepDistance || !search_conf.resolutionSchedule.empty();
+}
+
+double TreeSearch::getStepDistance(double clearance, double baseStepDistance) const
+{
+    if(search_conf.maxStepDistance <= baseStepDistance || clearance < search_conf.macroStepClearance)
+        return baseStepDistance;
+    
+    //the step must not leave the free disc around the node
+    const double step = std::min(search_conf.maxStepDistance, baseStepDistance + clearance - search_conf.macroStepClearance);
+    return std::max(baseStepDistance, std::min(step, clearance - getRobotRadius()));
+}
+
+double TreeSearch::getDiscount(double pathLength, double stepLength) const
+{
+    const double d = search_conf.discountFactor;
+    const double discount = pow(d, pathLength / search_conf.stepDistance);
+    if(d == 1.0 || stepLength == search_conf.stepDistance)
+        return discount;
+    
+    //mean discount over the normal steps covered by this step
+    const double steps = stepLength / search_conf.stepDistance;
+    return discount * (1.0 - pow(d, steps)) / ((1.0 - d) * steps);
+}
+
+const DirectionSampleTable& TreeSearch::getSampleTable(int resolutionLevel, double densityScale) const
+{
+    const std::vector<DirectionSampleTable> &tables(sampleTables[resolutionLevel]);
+    if(tables.size() == 1)
+        return tables.front();
+    
+    const double range = search_conf.samplingDensityMax - search_conf.samplingDensityMin;
+    int level = floor((densityScale - search_conf.samplingDensityMin) / range * (samplingDensityLevels - 1) + 0.5);
+    level = std::max(0, std::min(samplingDensityLevels - 1, level));
+    return tables[level];
+}
+
+NNLookup* TreeSearch::getNNLookup(const base::Vector3d& position) const
+{
+    return nnLookups[getResolutionLevel(position)];
+}
+
+TreeSearch::Angles TreeSearch::getDirectionsFromIntervals(const BinaryAngle &curDir, const TreeSearch::AngleIntervals& intervals, double densityScale)
 {
     TreeSearch::Angles ret;
+    const base::Angle curDirAngle(curDir.toAngle());
     
     if(printDebug)
     {
@@ -104,7 +253,7 @@ TreeSearch::Angles TreeSearch::getDirectionsFromIntervals(const base::Angle &cur
     for(std::vector<AngleSampleConf>::const_iterator it = search_conf.sampleAreas.begin(); it != search_conf.sampleAreas.end(); it++)
     {
         //create a sample interval aligned to the robot direction
-        base::AngleSegment sampleInterval(base::Angle::fromRad(it->intervalStart) + curDir, it->intervalWidth);
+        base::AngleSegment sampleInterval((BinaryAngle::fromRad(it->intervalStart) + curDir).toAngle(), it->intervalWidth);
         
         if(printDebug)
         {
@@ -125,9 +274,10 @@ TreeSearch::Angles TreeSearch::getDirectionsFromIntervals(const base::Angle &cur
             
             for(std::vector<base::AngleSegment>::const_iterator it3 = intersections.begin(); it3 != intersections.end(); it3++)
             {
-                addDirections(ret, *it3, it->angularSamplingMin, it->angularSamplingMax, it->angularSamplingNominalCount);
+                addDirections(ret, *it3, it->angularSamplingMin / densityScale, it->angularSamplingMax / densityScale,
+                              std::max(1, static_cast<int>(floor(it->angularSamplingNominalCount * densityScale + 0.5))));
                 
-                if(it3->isInside(curDir))
+                if(it3->isInside(curDirAngle))
                     ret.push_back(curDir);
             }
         }
@@ -137,20 +287,148 @@ TreeSearch::Angles TreeSearch::getDirectionsFromIntervals(const base::Angle &cur
     {
         std::cerr << "found " << ret.size() << " possible directions" << std::endl;
         for(Angles::iterator it = ret.begin(); it != ret.end(); it++)        
-            std::cout << *it << std::endl;
+            std::cout << it->getRad() << std::endl;
     }
     
     return ret;
 }
 
+void TreeSearch::getDrivableDirectionBins(const TreeNode& curNode, DirectionSampleTable::BinMask& drivable) const
+{
+    const DirectionSampleTable &sampleTable(sampleTables.front().front());
+    sampleTable.clearMask(drivable);
+    
+    const AngleIntervals intervals(getNextPossibleDirections(curNode));
+    const double binWidth = sampleTable.getBinWidth();
+    const int bins = sampleTable.getBinCount();
+    for(AngleIntervals::const_iterator it = intervals.begin(); it != intervals.end(); it++)
+    {
+        //mark all bins, whose start angle is inside of the interval
+        double start = it->getStart().getRad();
+        if(start < 0)
+            start += 2 * M_PI;
+        const int first = ceil(start / binWidth - 1e-6);
+        const int last = floor((start + it->getWidth()) / binWidth + 1e-6);
+        for(int i = first; i <= last && i - first < bins; i++)
+            DirectionSampleTable::setBin(drivable, i % bins);
+    }
+}
+
+/**
+ * Returns true if a node with cost \c cost is cheaper than an existing
+ * node with cost \c existingCost. Costs that only differ by the rounding
+ * of the sums along the two paths are treated as equal, so that
+ * equivalent nodes do not keep replacing each other's subtrees.
+ * */
+static bool isCheaper(double cost, double existingCost)
+{
+    return cost + 8 * std::numeric_limits<Scalar>::epsilon() * existingCost < existingCost;
+}
+
+void TreeSearch::removeDuplicateDirections(TreeSearch::Angles& directions, const BinaryAngle& curDir) const
+{
+    if(directions.size() < 2)
+        return;
+    
+    std::sort(directions.begin(), directions.end());
+    
+    const uint32_t epsilon = BinaryAngle::fromRad(search_conf.directionEpsilon).getRaw();
+    Angles::iterator last = directions.begin();
+    for(Angles::iterator it = directions.begin() + 1; it != directions.end(); it++)
+    {
+        if((*it - *last).getRaw() <= epsilon)
+        {
+            //prefer the current direction, as it does not need any turning
+            if(*it == curDir)
+                *last = *it;
+            continue;
+        }
+        
+        last++;
+        *last = *it;
+    }
+    
+    //the last and the first direction might be equal because of the wrap around
+    if(last != directions.begin() && (directions.front() - *last).getRaw() <= epsilon)
+    {
+        if(*last == curDir)
+            directions.front() = *last;
+        last--;
+    }
+    
+    directions.erase(last + 1, directions.end());
+}
+
 void TreeSearch::addDriveMode(DriveMode& driveMode)
 {
+    //the allowed drive modes are handled as a bitmask
+    if(driveModes.size() >= 64)
+        throw std::runtime_error("TreeSearch::addDriveMode: Error, at most 64 drive modes are supported");
+    
     driveModes.push_back(&driveMode);
+    allowedDriveModes.clear();
 }
 
 void TreeSearch::clearDriveModes()
 {
     driveModes.clear();
+    allowedDriveModes.clear();
+}
+
+void TreeSearch::compileDriveModeTransitions()
+{
+    const size_t nrModes = driveModes.size();
+    const uint64_t allModes = nrModes >= 64 ? ~static_cast<uint64_t>(0) : (static_cast<uint64_t>(1) << nrModes) - 1;
+    allowedDriveModes.assign(nrModes, allModes);
+    driveModeSwitchPenalties.assign(nrModes * nrModes, 0.0);
+    
+    for(std::vector<DriveModeTransition>::const_iterator it = search_conf.driveModeTransitions.begin(); it != search_conf.driveModeTransitions.end(); it++)
+    {
+        if(it->fromDriveMode < 0 || it->fromDriveMode >= static_cast<int>(nrModes) ||
+            it->toDriveMode < 0 || it->toDriveMode >= static_cast<int>(nrModes))
+            throw std::runtime_error("TreeSearch::compileDriveModeTransitions: Error, transition refers to an unknown drive mode");
+        
+        //staying in a drive mode is always allowed
+        if(it->fromDriveMode == it->toDriveMode)
+            continue;
+        
+        if(!it->allowed)
+            allowedDriveModes[it->fromDriveMode] &= ~(static_cast<uint64_t>(1) << it->toDriveMode);
+        driveModeSwitchPenalties[it->fromDriveMode * nrModes + it->toDriveMode] = it->penalty;
+    }
+}
+
+uint64_t TreeSearch::getAllowedDriveModes(const TreeNode& node) const
+{
+    //the drive mode of the root node is not known
+    if(node.isRoot())
+        return ~static_cast<uint64_t>(0);
+    
+    const uint8_t driveModeNr = node.getDriveModeNr();
+    if(search_conf.minDriveModeDwell > 0)
+    {
+        //count the steps the current drive mode was used for
+        int dwell = 0;
+        const TreeNode *it = &node;
+        while(!it->isRoot() && it->getDriveModeNr() == driveModeNr && dwell < search_conf.minDriveModeDwell)
+        {
+            dwell++;
+            it = it->getParent();
+        }
+        
+        if(dwell < search_conf.minDriveModeDwell && !it->isRoot())
+            return static_cast<uint64_t>(1) << driveModeNr;
+    }
+    
+    return allowedDriveModes[driveModeNr];
+}
+
+double TreeSearch::getDriveModeSwitchPenalty(const TreeNode& node, uint8_t driveModeNr) const
+{
+    if(node.isRoot())
+        return 0.0;
+    
+    return driveModeSwitchPenalties[node.getDriveModeNr() * driveModes.size() + driveModeNr];
 }
 
 double TreeSearch::getCostForNode(const ProjectedPose& projection, const base::Angle& direction, const TreeNode& parentNode)
@@ -158,14 +436,15 @@ double TreeSearch::getCostForNode(const ProjectedPose& projection, const base::A
     return projection.driveMode->getCostForNode(projection, direction, parentNode);
 }
 
-std::vector< ProjectedPose > TreeSearch::getProjectedPoses(const TreeNode& curNode, const base::Angle& heading, double distance)
+std::vector< ProjectedPose > TreeSearch::getProjectedPoses(const TreeNode& curNode, const BinaryAngle& heading, double distance, uint64_t driveModeMask)
 {
     int i = 0;
     std::vector< ProjectedPose > ret;
+    const base::Angle moveDirection((heading - curNode.getBinaryYaw()).toAngle());
     for(std::vector<DriveMode *>::const_iterator it = driveModes.begin(); it != driveModes.end(); it++)
     {
         ProjectedPose newPose;
-        if((*it)->projectPose(newPose, curNode, heading - curNode.getYaw() , distance))
+        if(((driveModeMask >> i) & 1) && (*it)->projectPose(newPose, curNode, moveDirection, distance))
         {
             newPose.driveMode = *it;
             newPose.driveModeNr = i;
@@ -183,6 +462,9 @@ TreeNode const* TreeSearch::compute(const base::Pose& start_world)
     {
         throw std::runtime_error("TreeSearch:: Error, no drive mode was registered");
     }
+    
+    TraceSpan setupSpan("TreeSearch::setup");
+    const base::Time setupStartTime = base::Time::now();
 
     if(tree.debugTree)
     {
@@ -192,23 +474,40 @@ TreeNode const* TreeSearch::compute(const base::Pose& start_world)
     
     base::Pose start(tree2World.inverse() * start_world.toTransform());
     tree.clear();
-    if(!nnLookup)
-	nnLookup = new NNLookup(1.0, search_conf.identityPositionThreshold / 2.0 , search_conf.identityYawThreshold / 2.0, driveModes.size());
+    //one duplicate detection per resolution level
+    if(nnLookups.empty())
+    {
+	nnLookups.push_back(new NNLookup(1.0, search_conf.identityPositionThreshold / 2.0 , search_conf.identityYawThreshold / 2.0, driveModes.size()));
+        for(std::vector<SearchResolution>::const_iterator it = search_conf.resolutionSchedule.begin(); it != search_conf.resolutionSchedule.end(); it++)
+            nnLookups.push_back(new NNLookup(1.0, it->identityPositionThreshold / 2.0 , it->identityYawThreshold / 2.0, driveModes.size()));
+    }
+    
+    for(std::vector<NNLookup *>::iterator it = nnLookups.begin(); it != nnLookups.end(); it++)
+        (*it)->clear();
+    
+    if(allowedDriveModes.size() != driveModes.size())
+        compileDriveModeTransitions();
     
-    nnLookup->clear();
-    TreeNode *curNode = tree.createRoot(start, base::Angle::fromRad(start.getYaw()));
-    curNode->setHeuristic(getHeuristic(*curNode));
+    TreeNode *curNode = tree.createRoot(start, BinaryAngle::fromRad(start.getYaw()));
+    startPosition = curNode->getPosition();
+    // The budget of this search, derived from the recent searches
+    // if the budget control is enabled
+    const bool budgetControl = budgetController.isEnabled();
+    const double samplingScale = budgetControl ? budgetController.getSamplingScale() : 1.0;
+    const double heuristicWeight = budgetControl ? budgetController.getHeuristicWeight() : 1.0;
+    
+    curNode->setHeuristic(heuristicWeight * getHeuristic(*curNode));
     curNode->setCost(0.0);
     
     //FIXME what is the current drive mode ?
     curNode->setDriveModeNr(0);
     curNode->setDriveMode(driveModes.at(0));
     
-    nnLookup->setNode(curNode);
+    getNNLookup(curNode->getPosition())->setNode(curNode);
 
     curNode->candidate_it = expandCandidates.insert(std::make_pair(curNode->getHeuristicCost(), curNode));
     
-    int max_depth = search_conf.maxTreeSize;
+    int max_depth = budgetControl ? budgetController.getNodeBudget() : search_conf.maxTreeSize;
     
     if(tree.debugTree)
     {
@@ -221,6 +520,8 @@ TreeNode const* TreeSearch::compute(const base::Pose& start_world)
     
     base::Time startTime = base::Time::now();
     
+    setupSpan.end();
+    TraceSpan searchSpan("TreeSearch::search");
     while(!expandCandidates.empty()) 
     {
         curNode = expandCandidates.begin()->second;
@@ -252,7 +553,7 @@ TreeNode const* TreeSearch::compute(const base::Pose& start_world)
             {
                 tree.debugTree->nodes[curNode->getIndex()].isValid = false;
             }
-	    nnLookup->clearIfSame(curNode);
+	    getNNLookup(curNode->getPosition())->clearIfSame(curNode);
 //             std::cout << "Node is invalid" << std::endl;
             continue;
         }
@@ -284,33 +585,65 @@ TreeNode const* TreeSearch::compute(const base::Pose& start_world)
 //         if(curNode->getPosition().x() > 1.0 && curNode->getPosition().x() < 2.0)
 //             ; //printDebug = true;
         
+        TraceSpan sampleSpan("sample", Trace::EXPANSIONS);
+        
+        // Sample more densely close to obstacles
+        // and take longer steps in free space
+        double clearance = -1;
+        if(search_conf.samplingDensityMin != search_conf.samplingDensityMax || search_conf.maxStepDistance > search_conf.stepDistance)
+            clearance = getClearance(*curNode);
+        const double densityScale = samplingScale * getSamplingDensityScale(clearance);
+        
+        // Use the resolution of the distance of the node from the start
+        const int resolutionLevel = getResolutionLevel(curNode->getPosition());
+        const double stepDistance = getStepDistance(clearance, getResolutionStepDistance(resolutionLevel));
+        
         // Get possible ways to go out of this node
-        AngleIntervals driveIntervals =
-            getNextPossibleDirections(*curNode);
+        Angles driveDirections;
+        if(!sampleTables.empty())
+        {
+            getDrivableDirectionBins(*curNode, drivableBins);
+            getSampleTable(resolutionLevel, densityScale).sample(curNode->getBinaryDirection(), drivableBins, driveDirections);
+        }
+        else
+        {
+            AngleIntervals driveIntervals =
+                getNextPossibleDirections(*curNode);
 
-        if (driveIntervals.empty())
-            continue;
+            if (driveIntervals.empty())
+                continue;
 
-        Angles driveDirections =
-            getDirectionsFromIntervals(curNode->getDirection(), driveIntervals);
+            driveDirections = getDirectionsFromIntervals(curNode->getBinaryDirection(), driveIntervals, densityScale * getResolutionSamplingScale(resolutionLevel));
+        }
+        
         if (driveDirections.empty())
             continue;
 
-        double curDiscount = pow(search_conf.discountFactor, curNode->getDepth());
+        removeDuplicateDirections(driveDirections, curNode->getBinaryDirection());
+
+        const double curDiscount = getDiscount(curNode->getPathLength(), stepDistance);
+        const double childPathLength = curNode->getPathLength() + stepDistance;
+        //the heuristic is discounted like in the case of
+        //normal steps, from one step before the child
+        const double heuristicDiscount = pow(search_conf.discountFactor, childPathLength / search_conf.stepDistance - 1.0);
+
+        // Drive modes the node may switch to
+        const uint64_t driveModeMask = getAllowedDriveModes(*curNode);
 
-        // Expand the node: add children in the directions returned by
-        // driveDirections
+        sampleSpan.end();
+        
+        // Project the node in all directions returned by driveDirections
+        // and drop all children, for which a better node already exists
+        TraceSpan projectSpan("project", Trace::EXPANSIONS);
+        childCandidates.clear();
         for (Angles::const_iterator it = driveDirections.begin(); it != driveDirections.end(); it++)
         {
-            if (max_depth > 0 && tree.getSize() >= max_depth)
-                break;
-
-            const base::Angle &curDirection(*it);
+            const BinaryAngle &curDirection(*it);
 
             //generate new node
             std::vector<ProjectedPose> projectedPoses =
                 getProjectedPoses(*curNode, curDirection,
-                        search_conf.stepDistance);
+                        stepDistance, driveModeMask);
 
             for(std::vector<ProjectedPose>::const_iterator projected = projectedPoses.begin(); projected != projectedPoses.end();projected++ )
             {
@@ -318,63 +651,118 @@ TreeNode const* TreeSearch::compute(const base::Pose& start_world)
                 if(!projected->nextPoseExists)
                     continue;
 
+                ChildCandidate candidate;
+                candidate.projection = *projected;
+                candidate.direction = curDirection;
+                
                 //compute cost for it
-                double nodeCost = curDiscount * getCostForNode(*projected, curDirection, *curNode);
+                candidate.nodeCost = curDiscount * (getCostForNode(*projected, curDirection.toAngle(), *curNode) +
+                                                    getDriveModeSwitchPenalty(*curNode, projected->driveModeNr));
 
-                
-                // Check that we are not doing the same work multiple times.
-                //
                 // searchNode should be used only here !
                 TreeNode searchNode(projected->pose, curDirection, projected->driveMode, projected->driveModeNr);
                 
-                const double searchNodeCost = nodeCost + curNode->getCost();
-                TreeNode *closest_node = nnLookup->getNodeWithinBounds(searchNode);
-                if(closest_node)
+                TreeNode *closest_node = getNNLookup(searchNode.getPosition())->getNodeWithinBounds(searchNode);
+                if(closest_node && !isCheaper(candidate.nodeCost + curNode->getCost(), closest_node->getCost()))
                 {
-                    if(closest_node->getCost() <= searchNodeCost)
-                    {
-                        //Existing node is better than current node
-                        //discard the current node
-                        continue;
-                    } 
-                    else
-                    {
-                        //remove from parent
-                        closest_node->parent->removeChild(closest_node);
-                        
-                        //remove closest node and subnodes
-                        removeSubtreeFromSearch(closest_node);                    
-                    }
+                    //Existing node is better than current node
+                    //discard the current node
+                    continue;
                 }
                 
+                candidate.heuristic = heuristicWeight * heuristicDiscount * getHeuristic(searchNode);
+                childCandidates.push_back(candidate);
+            }
+        }
+        
+        projectSpan.end();
+        
+        // Limit the branching factor, by only keeping
+        // the children with the lowest estimated cost
+        if(search_conf.maxChildrenPerExpansion > 0 && childCandidates.size() > static_cast<size_t>(search_conf.maxChildrenPerExpansion))
+        {
+            std::nth_element(childCandidates.begin(), childCandidates.begin() + search_conf.maxChildrenPerExpansion,
+                             childCandidates.end(), ChildCandidate::lowerEstimatedCost);
+            childCandidates.resize(search_conf.maxChildrenPerExpansion);
+        }
+        
+        // Expand the node: add the selected children
+        TraceSpan insertSpan("insert", Trace::EXPANSIONS);
+        for (std::vector<ChildCandidate>::const_iterator child = childCandidates.begin(); child != childCandidates.end(); child++)
+        {
+            if (max_depth > 0 && tree.getSize() >= max_depth)
+                break;
 
-                // Finally, create the new node and add it in the tree
-                TreeNode *newNode = tree.createChild(curNode, projected->pose, curDirection);
-                newNode->setDriveMode(projected->driveMode);
-                newNode->setDriveModeNr(projected->driveModeNr);
-                newNode->setCost(curNode->getCost() + nodeCost);
-                newNode->setCostFromParent(nodeCost);
-                newNode->setPositionTolerance(std::numeric_limits< double >::signaling_NaN());
-                newNode->setHeadingTolerance(std::numeric_limits< double >::signaling_NaN());
-                newNode->setHeuristic(curDiscount * getHeuristic(*newNode));
-
-                // Add it to the expand list
-                newNode->candidate_it = expandCandidates.insert(std::make_pair(newNode->getHeuristicCost(), newNode));
+            const ProjectedPose *projected = &(child->projection);
+            const BinaryAngle &curDirection(child->direction);
+            const double nodeCost = child->nodeCost;
 
-//                 std::cout << "Added new node " << newNode->getPose().position.transpose() << " Yaw " << newNode->getYaw() << " Cost " << newNode->getCost() << " Heuristic " << newNode->getHeuristicCost() << std::endl;
-                
-                if(tree.debugTree)
+            // Check that we are not doing the same work multiple times.
+            // This needs to be done again, as the children of this
+            // expansion might be close to each other
+            //
+            // searchNode should be used only here !
+            TreeNode searchNode(projected->pose, curDirection, projected->driveMode, projected->driveModeNr);
+            
+            const double searchNodeCost = nodeCost + curNode->getCost();
+            NNLookup *nnLookup = getNNLookup(searchNode.getPosition());
+            TreeNode *closest_node = nnLookup->getNodeWithinBounds(searchNode);
+            if(closest_node)
+            {
+                if(!isCheaper(searchNodeCost, closest_node->getCost()))
+                {
+                    //Existing node is better than current node
+                    //discard the current node
+                    continue;
+                } 
+                else
                 {
-                    DebugNode &dbg(tree.debugTree->nodes[newNode->getIndex()]);
-                    dbg.cost = newNode->getCost();
+                    //remove from parent
+                    closest_node->parent->removeChild(closest_node);
+                    
+                    //remove closest node and subnodes
+                    removeSubtreeFromSearch(closest_node);                    
                 }
-                
-                //add new node to nearest neighbour lookup
-                nnLookup->setNode(newNode);
             }
+            
+
+            // Finally, create the new node and add it in the tree
+            TreeNode *newNode = tree.createChild(curNode, projected->pose, curDirection);
+            newNode->setDriveMode(projected->driveMode);
+            newNode->setDriveModeNr(projected->driveModeNr);
+            newNode->setCost(curNode->getCost() + nodeCost);
+            newNode->setCostFromParent(nodeCost);
+            newNode->setPathLength(childPathLength);
+            newNode->setPositionTolerance(std::numeric_limits< double >::signaling_NaN());
+            newNode->setHeadingTolerance(std::numeric_limits< double >::signaling_NaN());
+            newNode->setHeuristic(child->heuristic);
+
+            // Add it to the expand list
+            newNode->candidate_it = expandCandidates.insert(std::make_pair(newNode->getHeuristicCost(), newNode));
+
+//             std::cout << "Added new node " << newNode->getPose().position.transpose() << " Yaw " << newNode->getYaw() << " Cost " << newNode->getCost() << " Heuristic " << newNode->getHeuristicCost() << std::endl;
+            
+            if(tree.debugTree)
+            {
+                DebugNode &dbg(tree.debugTree->nodes[newNode->getIndex()]);
+                dbg.cost = newNode->getCost();
+            }
+            
+            //add new node to nearest neighbour lookup
+            nnLookup->setNode(newNode);
         }
     }
 
+    searchSpan.end();
+    Trace::addCounter("treeSize", tree.getSize());
+    Trace::addCounter("expansions", candidateNr);
+    
+    if(budgetControl)
+    {
+        budgetController.addSearch(startTime - setupStartTime, base::Time::now() - setupStartTime, candidateNr, tree.getSize());
+        Trace::addCounter("nodeBudget", budgetController.getNodeBudget());
+    }
+    
     std::cout << "Created " << tree.getSize() << " Nodes " << " cur usage " << tree.nodes.size() << std::endl;
     expandCandidates.clear();
     
@@ -417,7 +805,7 @@ void TreeSearch::removeSubtreeFromSearch(TreeNode* node)
         node->candidate_it = expandCandidates.end();
     };
     
-    nnLookup->clearIfSame(node);
+    getNNLookup(node->getPosition())->clearIfSame(node);
     
     const std::vector<TreeNode *> &childs(node->getChildren());
     
@@ -446,6 +834,11 @@ const Tree& TreeSearch::getTree() const
     return tree;
 }
 
+const BudgetStats& TreeSearch::getBudgetStats() const
+{
+    return budgetController.getStats();
+}
+
 Tree::Tree()
     : size(0)
     , final_node(0)
@@ -471,7 +864,7 @@ void Tree::copyNodeChilds(const TreeNode* otherNode, TreeNode *ownNode, Tree con
 	it != otherNode->getChildren().end(); it++)
 	{
 	    TreeNode const* orig_node = *it;
-	    TreeNode* new_node = createChild(ownNode, orig_node->getPose(), orig_node->getDirection());
+	    TreeNode* new_node = createChild(ownNode, orig_node->getPose(), orig_node->getBinaryDirection());
 	    new_node->setCost(orig_node->getCost());
 	    new_node->setHeuristic(orig_node->getHeuristic());
 	    new_node->setHeadingTolerance(orig_node->getHeadingTolerance());
@@ -493,7 +886,7 @@ Tree& Tree::operator = (Tree const& other)
 
     if(other.root_node)
     {
-        root_node = createRoot(other.root_node->getPose(), other.root_node->getDirection());    
+        root_node = createRoot(other.root_node->getPose(), other.root_node->getBinaryDirection());    
         copyNodeChilds(other.root_node, root_node, other);
     }
     
@@ -524,6 +917,7 @@ std::vector< base::Trajectory > TreeSearch::buildTrajectoriesTo(const TreeNode*
 
 std::vector< base::Trajectory > TreeSearch::buildTrajectoriesTo(std::vector<const TreeNode *> nodes, const Eigen::Affine3d &world2Trajectory) const
 {    
+    TraceSpan span("buildTrajectoriesTo");
     std::vector<base::Trajectory> result;
 	
     if(nodes.empty())
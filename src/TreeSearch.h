@@ -16,6 +16,8 @@
 #include "DriveMode.hpp"
 #include "Tree.hpp"
 #include "NNLookup.hpp"
+#include "DirectionSampleTable.hpp"
+#include "BudgetController.hpp"
 
 namespace vfh_star {
 
@@ -28,9 +30,15 @@ class TreeSearch
     public:
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-        typedef std::vector<base::Angle> Angles;
+        typedef std::vector<BinaryAngle> Angles;
         typedef std::vector<base::AngleSegment> AngleIntervals;
 
+        /**
+         * Open list of the search, the nodes to be expanded
+         * ordered by their heuristic cost
+         * */
+        typedef std::multimap<Scalar, TreeNode *> OpenList;
+
 	TreeSearch();
         virtual ~TreeSearch();
 
@@ -42,6 +50,13 @@ class TreeSearch
         const TreeSearchConf& getSearchConf() const;
         Tree const& getTree() const;
 
+        /**
+         * Returns the measurements of the recent searches and the
+         * budget of the next one, if the budget control is enabled
+         * in the search configuration
+         * */
+        const BudgetStats &getBudgetStats() const;
+
         /**
          * This method is supposed to be called every time the 
          * config changed. It will drop all cached nodes etc.
@@ -70,7 +85,7 @@ class TreeSearch
         TreeNode const* compute(const base::Pose& start_world);
 
         
-	Angles getDirectionsFromIntervals(const base::Angle &curDir, const AngleIntervals& intervals);
+	Angles getDirectionsFromIntervals(const BinaryAngle &curDir, const AngleIntervals& intervals, double densityScale = 1.0);
 
         // The tree generated at the last call to getTrajectory
         Tree tree;
@@ -104,14 +119,86 @@ class TreeSearch
 	virtual AngleIntervals getNextPossibleDirections(
                 const TreeNode& curNode) const = 0;
 
+        /**
+         * Returns the drivable directions from the given node as bitmask
+         * over search_conf.directionBins bins in map frame. Is only used,
+         * if directionBins is set.
+         *
+         * The default implementation rasterizes the intervals returned
+         * by getNextPossibleDirections.
+         * */
+        virtual void getDrivableDirectionBins(const TreeNode& curNode,
+                DirectionSampleTable::BinMask &drivable) const;
+
+        /**
+         * Returns the distance of the node to the closest obstacle in meters,
+         * or a negative value if it is unknown.
+         *
+         * The default implementation returns -1.
+         * */
+        virtual double getClearance(const TreeNode& node) const;
+
+        /**
+         * Returns the radius of the robot including safety distances
+         * in meters. Macro steps are kept within the clearance minus
+         * this radius.
+         *
+         * The default implementation returns 0.
+         * */
+        virtual double getRobotRadius() const;
+
+        /**
+         * Returns the factor by which the angular sampling density
+         * is scaled at the given clearance.
+         * */
+        double getSamplingDensityScale(double clearance) const;
+
+        /**
+         * Returns the step distance used to expand a node with the given
+         * clearance. This is baseStepDistance, or a longer step in free space
+         * if maxStepDistance is configured.
+         * */
+        double getStepDistance(double clearance, double baseStepDistance) const;
+
+        /**
+         * Returns the index of the resolution that is used at the given
+         * position. Zero is the resolution of the search configuration,
+         * i + 1 the entry i of the resolution schedule.
+         * */
+        int getResolutionLevel(const base::Vector3d &position) const;
+        double getResolutionStepDistance(int level) const;
+        double getResolutionSamplingScale(int level) const;
+
+        /**
+         * Returns true if the search uses other step distances
+         * than stepDistance, due to macro steps or the resolution schedule
+         * */
+        bool hasVariableStepDistance() const;
+
+        /**
+         * Returns the discount applied on the cost of a step of length
+         * stepLength, that starts after travelling pathLength.
+         * This is discountFactor ^ (pathLength / stepDistance) for
+         * normal steps. Longer steps are discounted like the
+         * equivalent number of normal steps.
+         * */
+        double getDiscount(double pathLength, double stepLength) const;
+
+        /**
+         * Sampling policies compiled for search_conf.directionBins, per
+         * resolution level and sampling density level. Empty if
+         * directionBins is not set.
+         * */
+        std::vector<std::vector<DirectionSampleTable> > sampleTables;
                 
 
         /**
         * Project the curNode to new node candidat using all registered drive modes. 
         */
 	std::vector<ProjectedPose> getProjectedPoses(const TreeNode& curNode,
-                const base::Angle &heading,
-                double distance);
+                const BinaryAngle &heading,
+                double distance,
+                uint64_t driveModeMask = ~static_cast<uint64_t>(0));
 
         /**
          * This function is called to validate a node that has previously been
@@ -143,15 +230,63 @@ class TreeSearch
         
         void clearDriveModes();
     private:
+        /**
+         * A projected child of the node that is currently expanded
+         * */
+        struct ChildCandidate
+        {
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+            ProjectedPose projection;
+            BinaryAngle direction;
+            Scalar nodeCost;
+            Scalar heuristic;
+
+            static bool lowerEstimatedCost(const ChildCandidate &a, const ChildCandidate &b)
+            {
+                return a.nodeCost + a.heuristic < b.nodeCost + b.heuristic;
+            }
+        };
+
+        /**
+         * Sorts the directions and removes all directions, that are
+         * closer than search_conf.directionEpsilon to another one.
+         * */
+        void removeDuplicateDirections(Angles &directions, const BinaryAngle &curDir) const;
+
+        /**
+         * Compiles search_conf.driveModeTransitions for the
+         * registered drive modes
+         * */
+        void compileDriveModeTransitions();
+
+        /**
+         * Returns the bitmask of the drive modes, the node may be
+         * expanded with, according to the transitions and the
+         * minimum dwell of the drive modes
+         * */
+        uint64_t getAllowedDriveModes(const TreeNode &node) const;
+        double getDriveModeSwitchPenalty(const TreeNode &node, uint8_t driveModeNr) const;
         void addDirections(TreeSearch::Angles& directions, const base::AngleSegment &segement, const double minStep, const double maxStep, const int minNodes) const;
+        const DirectionSampleTable &getSampleTable(int resolutionLevel, double densityScale) const;
+        NNLookup *getNNLookup(const base::Vector3d &position) const;
 	void updateNodeCosts(TreeNode *node);
 	void removeSubtreeFromSearch(TreeNode *node);
         
 	Eigen::Affine3d tree2World;
 	
-	std::multimap<double, TreeNode *> expandCandidates;
+	OpenList expandCandidates;
         std::vector<DriveMode *> driveModes;
-	NNLookup *nnLookup;
+	std::vector<NNLookup *> nnLookups;
+        BudgetController budgetController;
+        ///position of the root node in tree coordinates
+        base::Vector3d startPosition;
+        DirectionSampleTable::BinMask drivableBins;
+        std::vector<ChildCandidate> childCandidates;
+        
+        ///drive modes that may follow each drive mode, as bitmask
+        std::vector<uint64_t> allowedDriveModes;
+        ///penalty of switching from drive mode i to j at i * driveModes.size() + j
+        std::vector<double> driveModeSwitchPenalties;
 };
 } // vfh_star namespace
 
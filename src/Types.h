@@ -9,6 +9,17 @@
 
 namespace vfh_star
 {
+    /**
+     * Scalar type of the poses and cost data of the search nodes and
+     * of the keys of the open list. Building with FLOAT_PRECISION
+     * defines VFH_STAR_FLOAT_PRECISION, which halves their size.
+     * */
+#ifdef VFH_STAR_FLOAT_PRECISION
+    typedef float Scalar;
+#else
+    typedef double Scalar;
+#endif
+
     class DebugNode
     {
     public:
@@ -74,6 +85,131 @@ namespace vfh_star
         double intervalWidth;
     };
     
+    /**
+     * Resolution of the search, used beyond a given distance from the start
+     * */
+    struct SearchResolution
+    {
+        SearchResolution() : startDistance(0), stepDistance(0.5), angularSamplingScale(1.0), identityPositionThreshold(-1), identityYawThreshold(-1) {}
+        
+        /** Distance from the start position in meters, from which on this resolution is used */
+        double startDistance;
+        
+        /** The distance in meters between two steps */
+        double stepDistance;
+        
+        /** The angular sampling density of the sample areas is multiplied by this factor */
+        double angularSamplingScale;
+        
+        /** 
+         * Identity thresholds of the duplicate detection. If negative they
+         * are derived like the ones of the TreeSearchConf
+         * */
+        double identityPositionThreshold;
+        double identityYawThreshold;
+    };
+    
+    /**
+     * Rule for switching from one drive mode to another. The drive
+     * modes are given by their number, i.e. the order they were
+     * added to the planner in.
+     * */
+    struct DriveModeTransition
+    {
+        DriveModeTransition() : fromDriveMode(0), toDriveMode(0), allowed(true), penalty(0) {}
+        
+        int fromDriveMode;
+        int toDriveMode;
+        
+        /** If false, the switch is never expanded */
+        bool allowed;
+        
+        /** Cost that is added to the node, at which the drive mode is switched */
+        double penalty;
+    };
+    
+    /**
+     * Adaptive work budget of the search. If a target latency is set,
+     * the node budget is derived from the time per node of the recent
+     * searches, so that the given percentile of the search times meets
+     * the target. If even minTreeSize nodes would take too long, the
+     * sampling density is lowered and the heuristic is weighted up.
+     * */
+    struct BudgetControlConf
+    {
+        BudgetControlConf() : percentile(0.9), window(20), minTreeSize(500), maxTreeSize(0), minSamplingScale(0.5), maxHeuristicWeight(1.5) {}
+        
+        /** Target search time, the budget control is off if it is null */
+        base::Time targetLatency;
+        
+        /** Percentile of the search times, that should meet the target */
+        double percentile;
+        
+        /** Number of recent searches the time per node is taken from */
+        int window;
+        
+        /** Lower limit of the node budget */
+        int minTreeSize;
+        
+        /**
+         * Upper limit of the node budget. If zero, the maxTreeSize
+         * of the search configuration is the upper limit.
+         * */
+        int maxTreeSize;
+        
+        /**
+         * Factor on the sampling density at full overload. With
+         * directionBins, the density does not go below the lowest
+         * compiled level, i.e. samplingDensityMin.
+         * */
+        double minSamplingScale;
+        
+        /** Weight of the heuristic at full overload */
+        double maxHeuristicWeight;
+    };
+    
+    /**
+     * Measurements and decisions of the budget control,
+     * see TreeSearch::getBudgetStats
+     * */
+    struct BudgetStats
+    {
+        BudgetStats() : plans(0), nsPerExpansion(0), nsPerNode(0), nodeBudget(0), overload(0), samplingScale(1.0), heuristicWeight(1.0) {}
+        
+        /** Number of searches in the window */
+        int plans;
+        
+        /** Search time of the last search */
+        base::Time lastLatency;
+        
+        /** Percentile of the search times in the window */
+        base::Time latencyPercentile;
+        
+        /** Percentile of the setup times in the window */
+        base::Time setupPercentile;
+        
+        /** Mean time per expansion of the searches in the window */
+        double nsPerExpansion;
+        
+        /** Percentile of the time per tree node in the window */
+        double nsPerNode;
+        
+        /** Node budget of the next search */
+        int nodeBudget;
+        
+        /**
+         * Zero if the target can be met with at least minTreeSize
+         * nodes, up to one if the budget is far below minTreeSize.
+         * */
+        double overload;
+        
+        /** Factor on the sampling density of the next search */
+        double samplingScale;
+        
+        /** Weight of the heuristic of the next search */
+        double heuristicWeight;
+    };
+    
     struct TreeSearchConf {
         ///maximum number of expanded nodes
         int maxTreeSize;
@@ -102,12 +238,101 @@ namespace vfh_star
 
         base::Time maxSeekTime;
         
+        /**
+         * If greater than zero, the sampling policies are compiled into
+         * lookup tables over this number of direction bins when the
+         * configuration is set. Drive directions are then sampled from
+         * a bitmask of drivable bins instead of from angle intervals.
+         * Should be set to the histogram size of the planner.
+         * */
+        int directionBins;
+        
+        /**
+         * Sampled directions that are closer than this
+         * angle (in rad) to each other are only expanded once
+         * */
+        double directionEpsilon;
+        
+        /**
+         * Maximum number of children that are added per expanded node.
+         * If more children are projected, the ones with the lowest
+         * estimated cost (cost + heuristic) are kept. Zero means unlimited.
+         * */
+        int maxChildrenPerExpansion;
+        
+        /**
+         * Clearance based sampling density. The angular sampling of the
+         * sample areas is scaled by a density factor, which is
+         * samplingDensityMax at a clearance of clearanceSamplingNear
+         * or below, and samplingDensityMin at a clearance of
+         * clearanceSamplingFar or above. In between it is interpolated
+         * linearly. A density of 2 means twice as many samples.
+         *
+         * The clearance is the distance of the node to the closest
+         * obstacle in meters. If the planner cannot tell the clearance,
+         * the density is 1.
+         * */
+        double clearanceSamplingNear;
+        double clearanceSamplingFar;
+        double samplingDensityMin;
+        double samplingDensityMax;
+        
+        /**
+         * Maximum length of a step in free space. If greater than
+         * stepDistance, nodes with a clearance above macroStepClearance
+         * are expanded with longer steps: the step grows by the amount
+         * the clearance exceeds macroStepClearance, up to maxStepDistance,
+         * but never beyond the clearance minus the robot radius.
+         * Costs are discounted by the travelled distance, so a long step
+         * is discounted like the equivalent number of normal steps.
+         * */
+        double maxStepDistance;
+        double macroStepClearance;
+        
+        /**
+         * Schedule of resolutions that are used far from the start, e.g.
+         * to use longer steps and coarser sampling at distances that
+         * are never executed before replanning. Nodes closer to the start
+         * than the first entry use the stepDistance, sampling and identity
+         * thresholds of this configuration. The entries get sorted by
+         * startDistance.
+         * */
+        std::vector<SearchResolution> resolutionSchedule;
+        
+        /**
+         * Rules for switching between the drive modes. Switches that
+         * are not listed are allowed without a penalty. Disallowed
+         * switches are not projected at all.
+         * */
+        std::vector<DriveModeTransition> driveModeTransitions;
+        
+        /**
+         * Minimum number of steps a drive mode has to be used for,
+         * before it may be switched again. Zero means no restriction.
+         * The drive mode of the start node is not known, so the first
+         * switch is always possible.
+         * */
+        int minDriveModeDwell;
+        
+        /** Adaptive node budget, off by default */
+        BudgetControlConf budgetControl;
+        
         TreeSearchConf()
             : maxTreeSize(0)
             , stepDistance(0.5)
             , discountFactor(1.0)
             , identityPositionThreshold(-1)
             , identityYawThreshold(-1)
+            , directionBins(0)
+            , directionEpsilon(0.001)
+            , maxChildrenPerExpansion(0)
+            , clearanceSamplingNear(0.5)
+            , clearanceSamplingFar(2.0)
+            , samplingDensityMin(1.0)
+            , samplingDensityMax(1.0)
+            , maxStepDistance(0.0)
+            , macroStepClearance(1.0)
+            , minDriveModeDwell(0)
     {
         sampleAreas.push_back(AngleSampleConf());
     };
@@ -117,16 +342,41 @@ namespace vfh_star
          * from the stepdistance and angularSamplingMin parameters
          * */
         void computePosAndYawThreshold();
+        
+        /**
+         * Returns the longest step the search can take, i.e. the
+         * largest of stepDistance, maxStepDistance and the step
+         * distances of the resolution schedule
+         * */
+        double getMaxStepDistance() const;
+        
+        static bool lowerStartDistance(const SearchResolution &a, const SearchResolution &b);
     };
 
+    enum ObstacleScanMode
+    {
+        /** Visit every cell within the sense radius */
+        SCAN_DENSE,
+        /** Only visit the obstacle cells, using an index of the obstacles per tile */
+        SCAN_SPARSE,
+        /** Scan a copy of the obstacles stored in Morton ordered 8x8 cell tiles */
+        SCAN_TILED
+    };
+    
     struct VFHConf
     {
         VFHConf(): obstacleSafetyDistance(0.0),
                     robotWidth(0.0),
+                    robotLength(0.0),
+                    footprintYawBins(16),
+                    maxClearance(0.0),
+                    sweptPathCheck(false),
+                    sweptStepLength(0.0),
                     obstacleSenseRadius(0.0), 
                     narrowThreshold(10), 
                     lowThreshold(6.0),
-                    histogramSize(90)
+                    histogramSize(90),
+                    obstacleScanMode(SCAN_DENSE)
         {
         }
         
@@ -136,6 +386,45 @@ namespace vfh_star
         //! the radius of the circle used to model the robot
         double robotWidth; 
 
+        /**
+         * Length of the robot along its heading. If greater than zero,
+         * the robot is modelled as a rectangle of robotLength x robotWidth
+         * and a configuration space is precomputed on every map update,
+         * which is used to validate nodes.
+         * */
+        double robotLength;
+
+        /**
+         * Number of yaw bins over [0, PI) used for the
+         * configuration space of the rectangular footprint
+         * */
+        int footprintYawBins;
+
+        /**
+         * If greater than zero, a distance field to the closest obstacle
+         * is computed on every map update, with distances capped at this
+         * value. It is used to answer clearance queries of the search.
+         * */
+        double maxClearance;
+
+        /**
+         * If true, the straight segment between a node and its
+         * parent is checked for collisions of the robot disc.
+         * This makes it safe to use step distances, that are
+         * larger than thin obstacles.
+         * */
+        bool sweptPathCheck;
+
+        /**
+         * Longest segment in meters the swept path check covers in one
+         * piece, longer segments are checked in pieces. This should be
+         * the longest step of the search, see
+         * TreeSearchConf::getMaxStepDistance. VFHStar uses the one of
+         * its search configuration if zero, a plain VFH the
+         * obstacleSenseRadius.
+         * */
+        double sweptStepLength;
+
         /**
          * Radius in which obstacles are sensed
          * per step.
@@ -160,6 +449,13 @@ namespace vfh_star
          * Number of directions covered by the histogram
          * */
         int histogramSize;
+
+        /**
+         * How the obstacles within the sense radius are found
+         * while generating the histogram. SCAN_SPARSE is faster on maps
+         * with few obstacles, but needs an additional index per map update.
+         * */
+        ObstacleScanMode obstacleScanMode;
     };
     
     struct VFHStarConf
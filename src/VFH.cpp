@@ -1,11 +1,14 @@
 #include "VFH.h"
+#include "Trace.hpp"
 #include <iomanip>
+#include <algorithm>
 
 using namespace Eigen;
 namespace vfh_star
 {
 
-VFH::VFH() : angularResolution(2*M_PI / config.histogramSize)
+VFH::VFH() : traversabillityGrid(NULL), rollingGrid(NULL), gridScale(0), gridOffsetX(0), gridOffsetY(0), 
+    gridWidth(0), gridHeight(0), rollingOriginX(0), rollingOriginY(0), angularResolution(2*M_PI / config.histogramSize)
 {
 }
 
@@ -13,6 +16,19 @@ void VFH::setConfig(const VFHConf& conf)
 {
     config = conf;
     angularResolution = 2*M_PI / config.histogramSize;
+    
+    //the sense radius and the footprint might have changed
+    if(rollingGrid)
+    {
+        setNewRollingGrid(rollingGrid);
+    }
+    else if(gridView.isValid())
+    {
+        computeObstacleBitmap();
+        computeConfigurationSpace();
+        computeSweptStencils();
+        computeDistanceField();
+    }
 }
 
 
@@ -41,23 +57,302 @@ void VFH::addDir(std::vector<base::AngleSegment> &drivableDirections, int start,
 
 void VFH::setNewTraversabilityGrid(const envire::TraversabilityGrid* trGrid)
 {
+    setNewGridView(GridView::fromTraversabilityGrid(*trGrid));
     traversabillityGrid = trGrid;
+}
+
+void VFH::setNewGridView(const GridView& view)
+{
+    TraceSpan span("VFH::setNewGridView");
+    traversabillityGrid = NULL;
+    rollingGrid = NULL;
+    gridView = view;
+    
+    gridScale = gridView.getScale();
+    gridOffsetX = gridView.getOffsetX();
+    gridOffsetY = gridView.getOffsetY();
+    gridWidth = gridView.getWidth();
+    gridHeight = gridView.getHeight();
+    
+    //precompute distances
+    lut.recompute(gridScale, 5.0);
+
+    computeObstacleBitmap();
+    computeConfigurationSpace();
+    computeSweptStencils();
+    computeDistanceField();
+}
+
+void VFH::swap(VFH& other)
+{
+    //the lookup table only depends on the grid scale. It has no
+    //swap, so it is only copied if the scales differ
+    if(gridScale != other.gridScale)
+        std::swap(lut, other.lut);
     
-    assert(traversabillityGrid->getScaleX() == traversabillityGrid->getScaleY());
+    //the derived maps swap their buffers instead of copying them
+    configurationSpace.swap(other.configurationSpace);
+    obstacleBitmap.swap(other.obstacleBitmap);
+    sweptStencils.swap(other.sweptStencils);
+    distanceField.swap(other.distanceField);
+    obstacleIndex.swap(other.obstacleIndex);
+    obstacleTiles.swap(other.obstacleTiles);
+    std::swap(traversabillityGrid, other.traversabillityGrid);
+    std::swap(rollingGrid, other.rollingGrid);
+    gridView.swap(other.gridView);
+    std::swap(gridScale, other.gridScale);
+    std::swap(gridOffsetX, other.gridOffsetX);
+    std::swap(gridOffsetY, other.gridOffsetY);
+    std::swap(gridWidth, other.gridWidth);
+    std::swap(gridHeight, other.gridHeight);
+    std::swap(rollingOriginX, other.rollingOriginX);
+    std::swap(rollingOriginY, other.rollingOriginY);
+    std::swap(config, other.config);
+    std::swap(angularResolution, other.angularResolution);
+    std::swap(debugActive, other.debugActive);
+}
+
+void VFH::setNewRollingGrid(const RollingGrid* grid)
+{
+    TraceSpan span("VFH::setNewRollingGrid");
+    traversabillityGrid = NULL;
+    gridView = GridView();
+    rollingGrid = grid;
+    
+    gridScale = rollingGrid->getScale();
+    gridOffsetX = rollingGrid->getOffsetX();
+    gridOffsetY = rollingGrid->getOffsetY();
+    gridWidth = rollingGrid->getWidth();
+    gridHeight = rollingGrid->getHeight();
+    rollingOriginX = rollingGrid->getOriginX();
+    rollingOriginY = rollingGrid->getOriginY();
     
     //precompute distances
-    lut.recompute(traversabillityGrid->getScaleX(), 5.0);
+    lut.recompute(gridScale, 5.0);
+
+    computeObstacleBitmap();
+    computeConfigurationSpace();
+    computeSweptStencils();
+    computeDistanceField();
+}
+
+void VFH::updateRollingGrid()
+{
+    if(!rollingGrid)
+        throw std::runtime_error("VFH::updateRollingGrid: Error, no rolling grid set");
+    
+    //move the derived maps along with the window
+    const int dx = rollingGrid->getOriginX() - rollingOriginX;
+    const int dy = rollingGrid->getOriginY() - rollingOriginY;
+    rollingOriginX = rollingGrid->getOriginX();
+    rollingOriginY = rollingGrid->getOriginY();
+    gridOffsetX = rollingGrid->getOffsetX();
+    gridOffsetY = rollingGrid->getOffsetY();
+    
+    obstacleBitmap.shift(dx, dy);
+    if(!distanceField.isEmpty())
+        distanceField.shift(dx, dy);
+    configurationSpace.shift(dx, dy);
+    
+    //the cells that moved away from the border of the window 
+    //lost their distance to the outside, which is an obstacle
+    std::vector<CellArea> dirtyAreas;
+    if(dx > 0)
+        dirtyAreas.push_back(CellArea(0, 0, 0, gridHeight - 1));
+    if(dx < 0)
+        dirtyAreas.push_back(CellArea(gridWidth - 1, 0, gridWidth - 1, gridHeight - 1));
+    if(dy > 0)
+        dirtyAreas.push_back(CellArea(0, 0, gridWidth - 1, 0));
+    if(dy < 0)
+        dirtyAreas.push_back(CellArea(0, gridHeight - 1, gridWidth - 1, gridHeight - 1));
+    
+    std::vector<bool> obstacleLookup;
+    computeObstacleLookup(obstacleLookup);
+    
+    const std::vector<CellArea> changedAreas(rollingGrid->getChangedAreas());
+    for(std::vector<CellArea>::const_iterator it = changedAreas.begin(); it != changedAreas.end(); it++)
+    {
+        //convert to window coordinates, areas may have left the window already
+        const CellArea area(std::max(0, it->minX - rollingOriginX), std::max(0, it->minY - rollingOriginY),
+                            std::min(gridWidth - 1, it->maxX - rollingOriginX), std::min(gridHeight - 1, it->maxY - rollingOriginY));
+        if(area.isEmpty())
+            continue;
+        
+        fillObstacleBitmap(obstacleLookup, area);
+        dirtyAreas.push_back(area);
+    }
+    
+    for(std::vector<CellArea>::const_iterator it = dirtyAreas.begin(); it != dirtyAreas.end(); it++)
+    {
+        if(!distanceField.isEmpty())
+            distanceField.update(obstacleBitmap, gridScale, config.maxClearance, it->minX, it->minY, it->maxX, it->maxY);
+        configurationSpace.update(obstacleBitmap, it->minX, it->minY, it->maxX, it->maxY);
+    }
+    
+    //a shift moves every obstacle, so then the indices are rebuilt
+    //completely, which is a word wise scan of the bitmap
+    if(dx || dy)
+    {
+        computeObstacleIndices();
+        return;
+    }
+    
+    for(std::vector<CellArea>::const_iterator it = dirtyAreas.begin(); it != dirtyAreas.end(); it++)
+    {
+        obstacleIndex.update(obstacleBitmap, it->minX, it->minY, it->maxX, it->maxY);
+        obstacleTiles.update(obstacleBitmap, it->minX, it->minY, it->maxX, it->maxY);
+    }
+}
+
+bool VFH::toGrid(double x, double y, int& cellX, int& cellY) const
+{
+    cellX = floor((x - gridOffsetX) / gridScale);
+    cellY = floor((y - gridOffsetY) / gridScale);
+    return cellX >= 0 && cellY >= 0 && cellX < gridWidth && cellY < gridHeight;
+}
+
+void VFH::computeObstacleLookup(std::vector< bool >& obstacleLookup) const
+{
+    if(!rollingGrid)
+    {
+        obstacleLookup = gridView.getObstacleClasses();
+        return;
+    }
+    
+    const std::vector<envire::TraversabilityClass> &trClasses(rollingGrid->getTraversabilityClasses());
+    
+    //go safe, unknown classes are obstacles
+    obstacleLookup.assign(256, true);
+    for(size_t i = 0; i < trClasses.size() && i < obstacleLookup.size(); i++)
+    {
+        obstacleLookup[i] = !trClasses[i].isTraversable();
+    }
+}
+
+void VFH::fillObstacleBitmap(const std::vector< bool >& obstacleLookup, const CellArea& area)
+{
+    if(!rollingGrid)
+    {
+        for(int y = area.minY; y <= area.maxY; y++)
+        {
+            for(int x = area.minX; x <= area.maxX; x++)
+                obstacleBitmap.setObstacle(x, y, obstacleLookup[gridView.getClass(x, y)]);
+        }
+        return;
+    }
+    
+    for(int y = area.minY; y <= area.maxY; y++)
+    {
+        for(int x = area.minX; x <= area.maxX; x++)
+            obstacleBitmap.setObstacle(x, y, obstacleLookup[rollingGrid->getClass(x, y)]);
+    }
+}
+
+void VFH::computeObstacleBitmap()
+{
+    std::vector<bool> obstacleLookup;
+    computeObstacleLookup(obstacleLookup);
+    
+    //the padding covers the sense area of any position in the grid,
+    //everything outside of the grid is an obstacle
+    const int padding = config.obstacleSenseRadius / gridScale + 1;
+    
+    obstacleBitmap.resize(gridWidth, gridHeight, padding);
+    fillObstacleBitmap(obstacleLookup, CellArea(0, 0, gridWidth - 1, gridHeight - 1));
+    
+    computeObstacleIndices();
+}
 
-    gridWidthHalf = traversabillityGrid->getWidth() / 2.0 * traversabillityGrid->getScaleX();
-    gridHeightHalf = traversabillityGrid->getHeight() / 2.0 * traversabillityGrid->getScaleY();
+void VFH::computeObstacleIndices()
+{
+    if(config.obstacleScanMode == SCAN_SPARSE)
+        obstacleIndex.compute(obstacleBitmap);
+    else
+        obstacleIndex.clear();
+    
+    if(config.obstacleScanMode == SCAN_TILED)
+        obstacleTiles.compute(obstacleBitmap);
+    else
+        obstacleTiles.clear();
+}
+
+void VFH::computeDistanceField()
+{
+    if(config.maxClearance <= 0)
+    {
+        distanceField.clear();
+        return;
+    }
+    
+    distanceField.compute(obstacleBitmap, gridScale, config.maxClearance);
+}
+
+double VFH::getClearance(const base::Vector3d& position) const
+{
+    if(distanceField.isEmpty())
+        return -1;
     
-    const std::vector<envire::TraversabilityClass> &trClasses(traversabillityGrid->getTraversabilityClasses());
-    obstacleLookup.clear();
-    obstacleLookup.reserve(trClasses.size());
-    for(std::vector<envire::TraversabilityClass>::const_iterator it = trClasses.begin(); it != trClasses.end();it++)
+    int x, y;
+    if(!toGrid(position.x(), position.y(), x, y))
+        return 0;
+    
+    return distanceField.getDistance(x, y);
+}
+
+void VFH::computeSweptStencils()
+{
+    if(!config.sweptPathCheck)
     {
-        obstacleLookup.push_back(!it->isTraversable());
+        sweptStencils.reset();
+        return;
     }
+    
+    //longer segments are checked in pieces
+    const double radius = config.robotWidth / 2.0 + config.obstacleSafetyDistance;
+    const double maxLength = config.sweptStepLength > 0 ? config.sweptStepLength : config.obstacleSenseRadius;
+    
+    //the stencils do not depend on the map, so they
+    //are kept until the scale or the configuration changes
+    if(sweptStencils && sweptStencils->isComputedFor(gridScale, radius, config.histogramSize, maxLength))
+        return;
+    
+    sweptStencils = SweptStencils::get(gridScale, radius, config.histogramSize, maxLength);
+}
+
+bool VFH::isSegmentFree(const base::Vector3d& start, const base::Vector3d& end) const
+{
+    if(!sweptStencils)
+        return true;
+    
+    return sweptStencils->isSegmentFree(obstacleBitmap,
+                                        (start.x() - gridOffsetX) / gridScale, (start.y() - gridOffsetY) / gridScale,
+                                        (end.x() - gridOffsetX) / gridScale, (end.y() - gridOffsetY) / gridScale);
+}
+
+void VFH::computeConfigurationSpace()
+{
+    if(config.robotLength <= 0)
+    {
+        configurationSpace.clear();
+        return;
+    }
+    
+    configurationSpace.compute(obstacleBitmap, gridScale,
+                               config.robotLength + 2.0 * config.obstacleSafetyDistance,
+                               config.robotWidth + 2.0 * config.obstacleSafetyDistance,
+                               config.footprintYawBins);
+}
+
+bool VFH::isColliding(const base::Pose& curPose) const
+{
+    if(configurationSpace.isEmpty())
+        return false;
+    
+    int x, y;
+    if(!toGrid(curPose.position.x(), curPose.position.y(), x, y))
+        return true;
+    
+    return configurationSpace.isColliding(x, y, curPose.getYaw());
 }
 
 const envire::TraversabilityGrid* VFH::getTraversabilityGrid() const
@@ -65,19 +360,34 @@ const envire::TraversabilityGrid* VFH::getTraversabilityGrid() const
     return traversabillityGrid;
 }
 
+GridView VFH::copyMap(std::vector< uint8_t >& cells) const
+{
+    if(!rollingGrid && !gridView.isValid())
+        return GridView();
+    
+    cells.resize(gridWidth * gridHeight);
+    for(int y = 0; y < gridHeight; y++)
+    {
+        for(int x = 0; x < gridWidth; x++)
+            cells[y * gridWidth + x] = rollingGrid ? rollingGrid->getClass(x, y) : gridView.getClass(x, y);
+    }
+    
+    std::vector<bool> obstacleLookup;
+    computeObstacleLookup(obstacleLookup);
+    
+    GridView view(&cells[0], gridWidth, gridHeight, gridWidth, gridScale, gridOffsetX, gridOffsetY);
+    for(int i = 0; i < 256; i++)
+        view.setObstacleClass(i, obstacleLookup[i]);
+    return view;
+}
+
 std::vector<base::AngleSegment> VFH::getNextPossibleDirections(const base::Pose& curPose) const
 {
     std::vector<base::AngleSegment> drivableDirections;
-    std::vector<double> histogram;
     std::vector<bool> bHistogram;
 
-    //4 degree steps
-    histogram.resize(config.histogramSize);
-
-    generateHistogram(histogram, curPose);
-
     //we ignore one obstacle
-    getBinaryHistogram(histogram, bHistogram);
+    getBinaryHistogram(curPose, bHistogram);
 
     
     int start = -1;
@@ -124,6 +434,61 @@ std::vector<base::AngleSegment> VFH::getNextPossibleDirections(const base::Pose&
     return drivableDirections;
 }
 
+void VFH::getDrivableBins(const base::Pose& curPose, std::vector< uint64_t >& drivable) const
+{
+    std::vector<bool> bHistogram;
+    getBinaryHistogram(curPose, bHistogram);
+
+    const int size = bHistogram.size();
+    drivable.assign((size + 63) / 64, 0);
+
+    //find an obstacle bin to start with, so that no gap wraps around
+    int start = -1;
+    for(int i = 0; i < size; i++)
+    {
+        if(!bHistogram[i])
+        {
+            start = i;
+            break;
+        }
+    }
+    
+    if(start < 0)
+    {
+        //all directions are free
+        for(int i = 0; i < size; i++)
+            drivable[i >> 6] |= static_cast<uint64_t>(1) << (i & 63);
+        return;
+    }
+    
+    int gapStart = -1;
+    for(int i = 1; i <= size; i++)
+    {
+        const int bin = (start + i) % size;
+        if(bHistogram[bin])
+        {
+            if(gapStart < 0)
+                gapStart = i;
+            continue;
+        }
+        
+        if(gapStart < 0)
+            continue;
+        
+        const int gapSize = i - gapStart;
+        for(int j = gapStart; j < i; j++)
+        {
+            //narrow gaps only contain the middle direction
+            if(gapSize < config.narrowThreshold && j != gapStart + gapSize / 2)
+                continue;
+            
+            const int gapBin = (start + j) % size;
+            drivable[gapBin >> 6] |= static_cast<uint64_t>(1) << (gapBin & 63);
+        }
+        gapStart = -1;
+    }
+}
+
 double normalize(double ang)
 {
     if(ang < 0)
@@ -139,30 +504,101 @@ bool VFH::validPosition(const base::Pose& curPose) const
 {
     //curPose is in map coordinates, as we converted it at the beginning
     //of the planning
-    const Vector3d curPos(curPose.position.x(), curPose.position.y(), 0);     
+    const double gridWidthHalf = gridWidth / 2.0 * gridScale;
+    const double gridHeightHalf = gridHeight / 2.0 * gridScale;
+    Vector3d curPos(curPose.position.x(), curPose.position.y(), 0);     
+    
+    //a rolling grid moves with the robot, away from the frame
+    //origin, so there the distance is measured to its center
+    if(rollingGrid)
+        curPos -= Vector3d(gridOffsetX + gridWidthHalf, gridOffsetY + gridHeightHalf, 0);
     double distanceToCenter = curPos.norm();
     
     return !(gridHeightHalf  - (distanceToCenter + config.obstacleSenseRadius) < 0) && !(gridWidthHalf - (distanceToCenter + config.obstacleSenseRadius) < 0);    
 }
 
-void VFH::generateHistogram(std::vector< double >& histogram, const base::Pose& curPose) const
+template <class Histogram>
+void VFH::addObstacleToHistogram(Histogram& histogram, int x, int y) const
 {
-    const int nrDirs = histogram.size();
-    
     const double a = 2.0;
     const double b = 1.0/ (config.obstacleSenseRadius * config.obstacleSenseRadius);
 
     const double radius = config.robotWidth / 2.0 + config.obstacleSafetyDistance;
     
-    std::vector<double> &dirs(histogram);    
+    double distToRobot = lut.getDistance(x, y);
+    double angleToObstace = lut.getAngle(x, y); // atan2(y, x);
+    
+    //convert to ENU
+//     angleToObstace -= M_PI / 2.0;
+    
+    //move to range 0 to 2*M_PI
+    angleToObstace = normalize(angleToObstace);
+    
+    //calculate magnitude m = c*(a-b*d²)
+    //ci is 1
+    double magnitude = a - b * distToRobot*distToRobot;
+
+//     std::cout << "Magnitude is " << magnitude << std::endl;
     
+    //in case we are allready hit the obstacle, we set distToRobot
+    //to (robotWidth + obstacleSafetyDist) which results in a 90 degree masking
+    //of the area where the collided obstable is
+    if((radius) > distToRobot)
+        distToRobot = (radius);
+    
+    //boundary of obstacle including robot width and safety distance
+    double y_t = asin(radius / distToRobot);
+    
+    //add to histogramm
+    int s = (angleToObstace - y_t) / angularResolution;
+    int e = (angleToObstace + y_t) / angularResolution;
+    histogram.add(s, e, magnitude);
+}
+
+void VFH::getBinaryHistogram(const base::Pose& curPose, std::vector< bool >& binHistogram) const
+{
+    //the fixed point histogram needs a threshold to scale to
+    if(config.lowThreshold > 0)
+    {
+        switch(config.histogramSize)
+        {
+            case 72:
+                getBinaryHistogram<FixedHistogram<72> >(curPose, binHistogram);
+                return;
+            case 90:
+                getBinaryHistogram<FixedHistogram<90> >(curPose, binHistogram);
+                return;
+            case 180:
+                getBinaryHistogram<FixedHistogram<180> >(curPose, binHistogram);
+                return;
+            case 360:
+                getBinaryHistogram<FixedHistogram<360> >(curPose, binHistogram);
+                return;
+            default:
+                break;
+        }
+    }
+    
+    getBinaryHistogram<DynamicHistogram>(curPose, binHistogram);
+}
+
+template <class Histogram>
+void VFH::getBinaryHistogram(const base::Pose& curPose, std::vector< bool >& binHistogram) const
+{
+    Histogram histogram(config.histogramSize, config.lowThreshold);
+    generateHistogram(histogram, curPose);
+    histogram.getBinary(binHistogram);
+}
+
+template <class Histogram>
+void VFH::generateHistogram(Histogram& histogram, const base::Pose& curPose) const
+{
     //calculate robot pos in grid coordinates
-    size_t robotX, robotY;
-    if(!traversabillityGrid->toGrid(curPose.position.x(), curPose.position.y(), robotX, robotY))
+    int robotX, robotY;
+    if(!toGrid(curPose.position.x(), curPose.position.y(), robotX, robotY))
       throw std::runtime_error("Internal Error, position is out of grid, this should be impossible");
     
-    const envire::TraversabilityGrid::ArrayType &gridData = traversabillityGrid->getGridData();    
-    const int senseSize = config.obstacleSenseRadius / traversabillityGrid->getScaleX();
+    const int senseSize = config.obstacleSenseRadius / gridScale;
 
 //     std::cout << "senseSize " << senseSize << std::endl;
     
@@ -191,81 +627,152 @@ void VFH::generateHistogram(std::vector< double >& histogram, const base::Pose&
 // 	std::cout <<  std::endl;
 //     }
     
-    //walk over area of grid within of circle with radius config.obstacleSenseRadius around the robot
+    switch(config.obstacleScanMode)
+    {
+        case SCAN_SPARSE:
+            generateHistogramSparse(histogram, robotX, robotY, senseSize);
+            break;
+        case SCAN_TILED:
+            generateHistogramTiled(histogram, robotX, robotY, senseSize);
+            break;
+        default:
+            generateHistogramDense(histogram, robotX, robotY, senseSize);
+            break;
+    }
+}
+
+template <class Histogram>
+void VFH::generateHistogramDense(Histogram& histogram, int robotX, int robotY, int senseSize) const
+{
+    //walk over area of grid within of circle with radius config.obstacleSenseRadius around the robot.
+    //The sense area is always within the padding of the bitmap, which is marked as obstacle,
+    //so the rows can be scanned word wise for obstacles
+    const int minX = robotX - senseSize;
+    const int maxX = robotX + senseSize;
     for(int y = -senseSize; y <= senseSize; y++)
     {
-	for(int x = -senseSize; x <= senseSize; x++)
-	{
-	    double distToRobot = lut.getDistance(x, y);
-	    
-	    //check if outside circle
-	    if(distToRobot > config.obstacleSenseRadius)
-		continue;
-	  
-	    int rx = robotX + x;
-	    int ry = robotY + y;
-	    
-// 	    std::cout << "rx " << rx << " ry " << ry << std::endl;
+        const int ry = robotY + y;
+        for(int rx = obstacleBitmap.findNextObstacle(ry, minX, maxX); rx <= maxX; 
+            rx = obstacleBitmap.findNextObstacle(ry, rx + 1, maxX))
+        {
+            const int x = rx - robotX;
+            
+            //check if outside circle
+            if(lut.getDistance(x, y) > config.obstacleSenseRadius)
+                continue;
+            
+            addObstacleToHistogram(histogram, x, y);
+        }
+    }
+}
 
-            bool inGrid = traversabillityGrid->inGrid(rx, ry);
-            //go safe, if we do not know anything about something, it is an obstacle
-            if(!inGrid || obstacleLookup[gridData[ry][rx]])
-	    {
-		double angleToObstace = lut.getAngle(x, y); // atan2(y, x);
-		
-		//convert to ENU
-// 		angleToObstace -= M_PI / 2.0;
-		
-		//move to range 0 to 2*M_PI
-		angleToObstace = normalize(angleToObstace);
-		
-		//calculate magnitude m = c*(a-b*d²)
-		//ci is 1
-		double magnitude = a - b * distToRobot*distToRobot;
-
-// 		std::cout << "Magnitude is " << magnitude << std::endl;
-		
-		//in case we are allready hit the obstacle, we set distToRobot
-		//to (robotWidth + obstacleSafetyDist) which results in a 90 degree masking
-		//of the area where the collided obstable is
-		if((radius) > distToRobot)
-		    distToRobot = (radius);
-		
-		//boundary of obstacle including robot width and safety distance
-		double y_t = asin(radius / distToRobot);
-		
-		//add to histogramm
-		int s = (angleToObstace - y_t) / angularResolution;
-		int e = (angleToObstace + y_t) / angularResolution;
-		for(int a = s; a <= e; a++) {
-		    int ac = a;
-		    if(ac < 0)
-			ac += nrDirs;
-		    
-		    if(ac >= nrDirs)
-			ac -=nrDirs;
-		    
-		    dirs[ac] += magnitude;
-		}
-	    }
-	}
+template <class Histogram>
+void VFH::generateHistogramSparse(Histogram& histogram, int robotX, int robotY, int senseSize) const
+{
+    const int width = obstacleBitmap.getWidth();
+    const int height = obstacleBitmap.getHeight();
+    const int tileSize = ObstacleIndex::tileSize;
+    
+    //only visit the obstacles in the tiles overlapping the sense area
+    const int minX = std::max(0, robotX - senseSize);
+    const int maxX = std::min(width - 1, robotX + senseSize);
+    const int minY = std::max(0, robotY - senseSize);
+    const int maxY = std::min(height - 1, robotY + senseSize);
+    for(int ty = minY / tileSize; ty <= maxY / tileSize; ty++)
+    {
+        for(int tx = minX / tileSize; tx <= maxX / tileSize; tx++)
+        {
+            if(obstacleIndex.isTileFree(tx, ty))
+                continue;
+            
+            const ObstacleIndex::Cell *end = obstacleIndex.getTileEnd(tx, ty);
+            for(const ObstacleIndex::Cell *cell = obstacleIndex.getTileBegin(tx, ty); cell != end; cell++)
+            {
+                const int x = cell->x - robotX;
+                const int y = cell->y - robotY;
+                if(abs(x) > senseSize || abs(y) > senseSize)
+                    continue;
+                
+                if(lut.getDistance(x, y) > config.obstacleSenseRadius)
+                    continue;
+                
+                addObstacleToHistogram(histogram, x, y);
+            }
+        }
+    }
+    
+    //go safe, everything outside of the grid is an obstacle.
+    //These cells are found in the padding of the bitmap
+    if(robotX - senseSize >= 0 && robotX + senseSize < width && robotY - senseSize >= 0 && robotY + senseSize < height)
+        return;
+    
+    for(int y = -senseSize; y <= senseSize; y++)
+    {
+        const int ry = robotY + y;
+        const bool outsideRow = ry < 0 || ry >= height;
+        for(int x = -senseSize; x <= senseSize; x++)
+        {
+            const int rx = robotX + x;
+            if(!outsideRow && rx >= 0 && rx < width)
+                continue;
+            
+            if(lut.getDistance(x, y) > config.obstacleSenseRadius)
+                continue;
+            
+            addObstacleToHistogram(histogram, x, y);
+        }
     }
 }
 
 
-void VFH::getBinaryHistogram(const std::vector< double >& histogram, std::vector< bool >& binHistogram) const
+template <class Histogram>
+void VFH::generateHistogramTiled(Histogram& histogram, int robotX, int robotY, int senseSize) const
 {
-    binHistogram.clear();
-    binHistogram.reserve(histogram.size());
-    for(std::vector<double>::const_iterator it = histogram.begin(); it != histogram.end(); it++) {
-	bool drivable = false;
-	
-	if(*it <= config.lowThreshold)
-	    drivable = true;
-	
-	//FIXME we are missing out the last binary histogramm
-	
-	binHistogram.push_back(drivable);
+    const int tileSize = ObstacleTiles::tileSize;
+    const uint64_t columnsOfRow = 0x0101010101010101ULL;
+    
+    const int minX = robotX - senseSize;
+    const int maxX = robotX + senseSize;
+    const int minY = robotY - senseSize;
+    const int maxY = robotY + senseSize;
+    const int minTileX = obstacleTiles.getTileX(minX);
+    const int maxTileX = obstacleTiles.getTileX(maxX);
+    const int minTileY = obstacleTiles.getTileY(minY);
+    const int maxTileY = obstacleTiles.getTileY(maxY);
+    
+    for(int ty = minTileY; ty <= maxTileY; ty++)
+    {
+        //mask out the rows of the tile outside of the sense area
+        const int originY = obstacleTiles.getTileOriginY(ty);
+        const int firstRow = std::max(0, minY - originY);
+        const int lastRow = std::min(tileSize - 1, maxY - originY);
+        const uint64_t rowMask = (~static_cast<uint64_t>(0) << (firstRow * tileSize)) &
+                                 (~static_cast<uint64_t>(0) >> ((tileSize - 1 - lastRow) * tileSize));
+        
+        for(int tx = minTileX; tx <= maxTileX; tx++)
+        {
+            //mask out the columns of the tile outside of the sense area
+            const int originX = obstacleTiles.getTileOriginX(tx);
+            const int firstColumn = std::max(0, minX - originX);
+            const int lastColumn = std::min(tileSize - 1, maxX - originX);
+            const uint64_t columnMask = ((0xffu << firstColumn) & (0xffu >> (tileSize - 1 - lastColumn))) * columnsOfRow;
+            
+            uint64_t bits = obstacleTiles.getTile(tx, ty) & rowMask & columnMask;
+            while(bits)
+            {
+                const int bit = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                
+                const int x = originX + (bit & (tileSize - 1)) - robotX;
+                const int y = originY + bit / tileSize - robotY;
+                
+                //check if outside circle
+                if(lut.getDistance(x, y) > config.obstacleSenseRadius)
+                    continue;
+                
+                addObstacleToHistogram(histogram, x, y);
+            }
+        }
     }
 }
 }
@@ -8,6 +8,15 @@
 #include <envire/tools/RadialLookUpTable.hpp>
 
 #include "Types.h"
+#include "ConfigurationSpace.hpp"
+#include "ObstacleBitmap.hpp"
+#include "SweptStencils.hpp"
+#include "DistanceField.hpp"
+#include "ObstacleIndex.hpp"
+#include "ObstacleTiles.hpp"
+#include "RollingGrid.hpp"
+#include "GridView.hpp"
+#include "Histogram.hpp"
 #include <base/Angle.hpp>
 
 namespace vfh_star
@@ -19,26 +28,152 @@ namespace vfh_star
         std::vector< base::AngleSegment >
             getNextPossibleDirections(const base::Pose& curPose) const;
 
+        /**
+         * Writes the binary histogram at the given pose as bitmask into
+         * drivable, one bit per histogram bin. Narrow gaps are reduced
+         * to their middle bin, like in getNextPossibleDirections.
+         * */
+        void getDrivableBins(const base::Pose& curPose, std::vector<uint64_t> &drivable) const;
+
         void setConfig(const VFHConf &conf);
+
+        const VFHConf &getConfig() const
+        {
+            return config;
+        }
         
 	/**
 	 * Return weather vfh can return possible directions for this position
 	 * */
 	bool validPosition(const base::Pose& curPose) const;
 	
+        /**
+         * Returns true if the robot footprint collides with an obstacle
+         * at the given pose. This is only available if a rectangular
+         * footprint is configured (robotLength > 0), otherwise collisions
+         * are only covered by the histogram and false is returned.
+         * */
+        bool isColliding(const base::Pose& curPose) const;
+
+        /**
+         * Returns true if the robot disc can move on a straight line
+         * from the start to the end position without hitting an obstacle.
+         * This is only checked if sweptPathCheck is enabled, otherwise
+         * true is returned.
+         * */
+        bool isSegmentFree(const base::Vector3d& start, const base::Vector3d& end) const;
+
+        /**
+         * Returns the distance from the given position to the closest
+         * obstacle, capped at maxClearance. Returns -1 if maxClearance
+         * is not configured.
+         * */
+        double getClearance(const base::Vector3d& position) const;
+
+        /**
+         * Uses the given envire grid as map. The grid is
+         * accessed through a GridView and must stay valid,
+         * as long as it is used.
+         * */
         void setNewTraversabilityGrid(const envire::TraversabilityGrid *trGrid);
+
+        /**
+         * Returns the envire grid, if the map was set by
+         * setNewTraversabilityGrid, otherwise NULL
+         * */
         const envire::TraversabilityGrid *getTraversabilityGrid() const;
+
+        /**
+         * Copies the cells of the current map row by row into cells
+         * and returns a view of the copy, including which classes are
+         * obstacles. Returns an invalid view if no map is set.
+         * */
+        GridView copyMap(std::vector<uint8_t> &cells) const;
+
+        /**
+         * Uses the map memory behind the given view, without
+         * copying it. The memory must stay valid, as long as it is used.
+         * */
+        void setNewGridView(const GridView &view);
+
+        /**
+         * Exchanges the map, the derived maps and the
+         * configuration with the ones of other
+         * */
+        void swap(VFH &other);
+
+        /**
+         * Uses the given rolling grid as map, instead of
+         * a traversability grid. The grid must stay valid,
+         * as long as it is used.
+         * */
+        void setNewRollingGrid(const RollingGrid *grid);
+
+        /**
+         * Updates the derived maps after the rolling grid was
+         * moved or written. The derived maps are moved along with
+         * the window and only the changed areas of the grid are
+         * recomputed. The changed areas of the grid are not cleared,
+         * this is up to the owner of the grid.
+         * */
+        void updateRollingGrid();
         
     private:
-        void generateHistogram(std::vector< double >& histogram, const base::Pose& curPose) const;
+        /**
+         * Computes the binary histogram at the given pose. Common
+         * histogram sizes use a FixedHistogram, others a DynamicHistogram.
+         * */
+        void getBinaryHistogram(const base::Pose& curPose, std::vector< bool >& binHistogram) const;
+        template <class Histogram>
+        void getBinaryHistogram(const base::Pose& curPose, std::vector< bool >& binHistogram) const;
+
+        template <class Histogram>
+        void generateHistogram(Histogram& histogram, const base::Pose& curPose) const;
+        template <class Histogram>
+        void generateHistogramDense(Histogram& histogram, int robotX, int robotY, int senseSize) const;
+        template <class Histogram>
+        void generateHistogramSparse(Histogram& histogram, int robotX, int robotY, int senseSize) const;
+        template <class Histogram>
+        void generateHistogramTiled(Histogram& histogram, int robotX, int robotY, int senseSize) const;
+        
+        /**
+         * Adds the obstacle at the position x, y relative
+         * to the robot (in cells) to the histogram
+         * */
+        template <class Histogram>
+        void addObstacleToHistogram(Histogram& histogram, int x, int y) const;
 
-        void getBinaryHistogram(const std::vector< double >& histogram, std::vector< bool >& binHistogram) const;
         void addDir(std::vector< base::AngleSegment >& drivableDirections, int start, int end) const;
+        bool toGrid(double x, double y, int &cellX, int &cellY) const;
+        void computeObstacleLookup(std::vector<bool> &obstacleLookup) const;
+        void fillObstacleBitmap(const std::vector<bool> &obstacleLookup, const CellArea &area);
+        void computeObstacleBitmap();
+        void computeObstacleIndices();
+        void computeConfigurationSpace();
+        void computeSweptStencils();
+        void computeDistanceField();
 	envire::RadialLookUpTable lut;
-        std::vector<bool> obstacleLookup;
+        ConfigurationSpace configurationSpace;
+        ObstacleBitmap obstacleBitmap;
+        ///shared by all maps with the same scale and configuration
+        boost::shared_ptr<const SweptStencils> sweptStencils;
+        DistanceField distanceField;
+        ObstacleIndex obstacleIndex;
+        ObstacleTiles obstacleTiles;
         const envire::TraversabilityGrid *traversabillityGrid;
-        double gridWidthHalf;
-        double gridHeightHalf;
+        const RollingGrid *rollingGrid;
+        GridView gridView;
+        
+        ///geometry of the current grid
+        double gridScale;
+        double gridOffsetX;
+        double gridOffsetY;
+        int gridWidth;
+        int gridHeight;
+        
+        ///origin of the rolling grid, the derived maps were computed for
+        int rollingOriginX;
+        int rollingOriginY;
 
         VFHConf config;
         double angularResolution;
@@ -1,4 +1,5 @@
 #include "VFHStar.h"
+#include "Trace.hpp"
 #include <Eigen/Core>
 #include <map>
 #include <iostream>
@@ -6,7 +7,7 @@
 using namespace vfh_star;
 using namespace Eigen;
 
-VFHStar::VFHStar()
+VFHStar::VFHStar() : planCapture(NULL)
 {
 }
 
@@ -22,26 +23,159 @@ const VFHStarConf& VFHStar::getCostConf() const
 void VFHStar::setCostConf(const VFHStarConf& conf)
 {
     vfhStarConf = conf;
-    vfh.setConfig(vfhStarConf.vfhConf);
+    
+    VFHConf vfhConf(vfhStarConf.vfhConf);
+    if(vfhConf.sweptStepLength <= 0)
+        vfhConf.sweptStepLength = search_conf.getMaxStepDistance();
+    vfh.setConfig(vfhConf);
+}
+
+const VFHConf& VFHStar::getVFHConf() const
+{
+    return vfh.getConfig();
 }
 
 double VFHStar::getHeuristic(const TreeNode &node) const
 {
     double d_to_goal = HorizonPlanner::getHeuristic(node);
 
-    int steps = ceil(d_to_goal / search_conf.stepDistance);
-    double result = 0;
-    while (steps-- > 0)
-        result = result * search_conf.discountFactor + 1;
+    //number of steps to the goal. With variable step distances
+    //the goal might be reached with a fraction of a step.
+    //The tolerance keeps rounding errors of the node positions
+    //from adding a whole step, which would overestimate the cost
+    double steps = d_to_goal / search_conf.stepDistance;
+    if(!hasVariableStepDistance())
+        steps = ceil(steps - 1e-3);
+    
+    //sum of discountFactor^i for all steps
+    const double d = search_conf.discountFactor;
+    double result = steps;
+    if(d != 1.0)
+        result = (1.0 - pow(d, steps)) / (1.0 - d);
     
     return result * search_conf.discountFactor * search_conf.stepDistance * vfhStarConf.distanceWeight;
 }
 
 void VFHStar::setNewTraversabilityGrid(const envire::TraversabilityGrid* trGrid)
 {
+    TraceSpan span("setNewTraversabilityGrid");
+    mapSnapshot.reset();
     vfh.setNewTraversabilityGrid(trGrid);
 }
 
+void VFHStar::setNewGridView(const GridView& view)
+{
+    TraceSpan span("setNewGridView");
+    mapSnapshot.reset();
+    vfh.setNewGridView(view);
+}
+
+void VFHStar::setNewMappedGrid(const MappedGrid& grid, const base::Vector3d& position, double size)
+{
+    TraceSpan span("setNewMappedGrid");
+    mapSnapshot.reset();
+    vfh.setNewGridView(grid.getView(position.x(), position.y(), size));
+}
+
+bool VFHStar::takePreprocessedMap(MapPreprocessor& preprocessor)
+{
+    boost::shared_ptr<VFH> next(preprocessor.takeResult());
+    if(!next)
+        return false;
+    
+    mapSnapshot.reset();
+    
+    //the old map is freed together with next
+    vfh.swap(*next);
+    return true;
+}
+
+void VFHStar::setMapSnapshot(const MapSnapshotPtr& snapshot)
+{
+    mapSnapshot = snapshot;
+}
+
+void VFHStar::setPlanCapture(PlanCaptureWriter* capture)
+{
+    planCapture = capture;
+}
+
+const TreeNode* VFHStar::computePath(const base::Pose& start, const base::Angle& mainHeading, double horizon, const Eigen::Affine3d& body2Trajectory)
+{
+    if(!planCapture)
+        return HorizonPlanner::computePath(start, mainHeading, horizon, body2Trajectory);
+    
+    PlanRecord record;
+    record.start = start;
+    record.mainHeading = mainHeading.getRad();
+    record.horizon = horizon;
+    record.treeToWorld = getTreeToWorld();
+    record.searchConf = search_conf;
+    record.costConf = vfhStarConf;
+    //a snapshot brings its own VFH configuration
+    record.costConf.vfhConf = getVFH().getConfig();
+    
+    const GridView map(getVFH().copyMap(record.cells));
+    if(map.isValid())
+    {
+        record.width = map.getWidth();
+        record.height = map.getHeight();
+        record.scale = map.getScale();
+        record.offsetX = map.getOffsetX();
+        record.offsetY = map.getOffsetY();
+        record.obstacleClasses = map.getObstacleClasses();
+    }
+    
+    const base::Time startTime = base::Time::now();
+    const TreeNode *node = HorizonPlanner::computePath(start, mainHeading, horizon, body2Trajectory);
+    record.planningTime = base::Time::now() - startTime;
+    record.setResult(node, tree.getSize());
+    
+    planCapture->write(record);
+    return node;
+}
+
+void VFHStar::prepareReplay(const PlanRecord& record)
+{
+    setTreeToWorld(record.treeToWorld);
+    //setting the configuration resets the search tables,
+    //which would be measured as part of the next search
+    if(!isSameConfig(record.searchConf, getSearchConf()))
+        setSearchConf(record.searchConf);
+    //set the map first, the current one might not exist anymore
+    setNewGridView(record.getGridView());
+    //the record holds the VFH configuration the maps were computed with
+    VFHStarConf costConf(getCostConf());
+    costConf.vfhConf = getVFHConf();
+    if(!isSameConfig(record.costConf, costConf))
+        setCostConf(record.costConf);
+}
+
+const TreeNode* VFHStar::replay(const PlanRecord& record)
+{
+    prepareReplay(record);
+    return computePath(record.start, base::Angle::fromRad(record.mainHeading), record.horizon);
+}
+
+const VFH& VFHStar::getVFH() const
+{
+    if(mapSnapshot)
+        return mapSnapshot->getVFH();
+    
+    return vfh;
+}
+
+void VFHStar::setNewRollingGrid(const RollingGrid* grid)
+{
+    mapSnapshot.reset();
+    vfh.setNewRollingGrid(grid);
+}
+
+void VFHStar::updateRollingGrid()
+{
+    vfh.updateRollingGrid();
+}
+
 double VFHStar::getCostForNode(const ProjectedPose& projection, const base::Angle &direction, const TreeNode& parentNode) const
 {
     /**
@@ -59,9 +193,15 @@ double VFHStar::getCostForNode(const ProjectedPose& projection, const base::Angl
     
     const base::Pose &pose(projection.pose);
     
-    double aPart = fabs((base::Angle::fromRad(pose.getYaw()) - mainHeading).getRad());
+    double aPart = fabs((BinaryAngle::fromRad(pose.getYaw()) - mainHeading).getRad());
     double bPart = (pose.position - parentNode.getPose().position).norm();
-    double cPart = fabs((direction - parentNode.getDirection()).getRad());
+    double cPart = fabs((BinaryAngle::fromAngle(direction) - parentNode.getBinaryDirection()).getRad());
+
+    //the heading difference is charged per normal step, so that
+    //a long step costs as much as the equivalent normal steps.
+    //These would turn only once, so the turn is charged once.
+    if(hasVariableStepDistance())
+        aPart *= bPart / search_conf.stepDistance;
 
     double distToTarget = algebraicDistanceToGoalLine(pose.position);
     if(distToTarget < bPart)
@@ -72,12 +212,40 @@ double VFHStar::getCostForNode(const ProjectedPose& projection, const base::Angl
 
 TreeSearch::AngleIntervals VFHStar::getNextPossibleDirections(const TreeNode& curNode) const
 {
-    return vfh.getNextPossibleDirections(curNode.getPose());
+    return getVFH().getNextPossibleDirections(curNode.getPose());
+}
+
+void VFHStar::getDrivableDirectionBins(const TreeNode& curNode, DirectionSampleTable::BinMask& drivable) const
+{
+    if(getVFH().getConfig().histogramSize != search_conf.directionBins)
+    {
+        TreeSearch::getDrivableDirectionBins(curNode, drivable);
+        return;
+    }
+    
+    getVFH().getDrivableBins(curNode.getPose(), drivable);
+}
+
+double VFHStar::getClearance(const TreeNode& node) const
+{
+    return getVFH().getClearance(node.getPosition());
+}
+
+double VFHStar::getRobotRadius() const
+{
+    const VFHConf &conf(getVFH().getConfig());
+    return sqrt(conf.robotWidth * conf.robotWidth + conf.robotLength * conf.robotLength) / 2.0 + conf.obstacleSafetyDistance;
 }
 
 bool VFHStar::validateNode(const TreeNode& node) const
 {
-    return vfh.validPosition(node.getPose());
+    if(!getVFH().validPosition(node.getPose()) || getVFH().isColliding(node.getPose()))
+        return false;
+    
+    if(!node.isRoot() && !getVFH().isSegmentFree(node.getParent()->getPosition(), node.getPosition()))
+        return false;
+    
+    return true;
 }
 
 VFHStarDebugData VFHStar::getVFHStarDebugData(const std::vector< base::Waypoint >& trajectory)
@@ -3,6 +3,10 @@
 
 #include "HorizonPlanner.hpp"
 #include "VFH.h"
+#include "MappedGrid.hpp"
+#include "MapPreprocessor.hpp"
+#include "MapSnapshot.hpp"
+#include "PlanCapture.hpp"
 #include "Types.h"
 
 namespace vfh_star {
@@ -15,6 +19,17 @@ class VFHStar : public HorizonPlanner
         void setCostConf(const VFHStarConf& config);
         const VFHStarConf& getCostConf() const;
 
+        /**
+         * Returns the VFH configuration of getCostConf(), with the
+         * sweptStepLength set to the longest step of the search
+         * configuration if it is zero. This is the configuration the
+         * own maps are computed with, and should be given to
+         * MapSnapshot::create and MapPreprocessor::submit. It is
+         * taken when setCostConf is called, so the search
+         * configuration should be set first.
+         * */
+        const VFHConf &getVFHConf() const;
+
 
 	
         /**
@@ -24,11 +39,84 @@ class VFHStar : public HorizonPlanner
          * */
 	void setNewTraversabilityGrid(const envire::TraversabilityGrid *trGrid);
 
+        /**
+         * Sets a new map in externally owned memory,
+         * see VFH::setNewGridView.
+         * */
+        void setNewGridView(const GridView &view);
+
+        /**
+         * Sets the window with the given size in meters around the
+         * given position of a memory mapped map as new map. Only the
+         * pages of the window are read from the map file.
+         * */
+        void setNewMappedGrid(const MappedGrid &grid, const base::Vector3d &position, double size);
+
+        /**
+         * Replaces the current map by the latest map finished by the
+         * given preprocessor, if there is one. Must be called between
+         * two plans. Returns true if the map was replaced.
+         *
+         * The preprocessed map brings its own VFH configuration,
+         * which should be the one of getVFHConf().
+         * */
+        bool takePreprocessedMap(MapPreprocessor &preprocessor);
+
+        /**
+         * Uses the given shared snapshot as map, until another map is
+         * set. The snapshot is only read, so several planners may use
+         * it concurrently. The VFH configuration of the snapshot is used
+         * instead of getVFHConf().
+         * */
+        void setMapSnapshot(const MapSnapshotPtr &snapshot);
+
+        /**
+         * Uses a rolling local map instead of a traversability map.
+         * After moving or writing the grid, updateRollingGrid
+         * must be called before the next planning.
+         * */
+        void setNewRollingGrid(const RollingGrid *grid);
+        void updateRollingGrid();
+
         VFHStarDebugData getVFHStarDebugData(const std::vector< base::Waypoint >& trajectory);
+
+        /**
+         * Records the inputs and the result of every following call of
+         * computePath into the given capture. The map is copied on
+         * every call, so this is meant for debugging sessions. NULL
+         * stops the capturing. The capture must outlive its use.
+         * */
+        void setPlanCapture(PlanCaptureWriter *capture);
+
+        /**
+         * Replaces the map, the configurations and the tree frame of
+         * the planner by the ones of the record. The drive modes are the
+         * ones of the planner. The configurations are only set if they
+         * differ from the current ones of the planner, as setting them
+         * resets the search tables. The record must outlive the use of
+         * the map.
+         * */
+        void prepareReplay(const PlanRecord &record);
+
+        /**
+         * Computes the path with the inputs of the given record,
+         * after calling prepareReplay
+         * */
+        const TreeNode *replay(const PlanRecord &record);
+
+        virtual const TreeNode* computePath(const base::Pose& start, const base::Angle& mainHeading, double horizon, const Eigen::Affine3d& body2Trajectory = Eigen::Affine3d::Identity());
         
     protected:
         VFHStarConf vfhStarConf;
         VFH vfh;
+        MapSnapshotPtr mapSnapshot;
+        PlanCaptureWriter *planCapture;
+    
+        /**
+         * Returns the VFH of the map snapshot, if one is set,
+         * otherwise the own one
+         * */
+        const VFH &getVFH() const;
     
         /** Returns the estimated cost from the given node to the optimal node
          * reachable from that node. Note that this estimate must be a minorant,
@@ -49,7 +137,25 @@ class VFHStar : public HorizonPlanner
          * */
         AngleIntervals getNextPossibleDirections(const TreeNode& curNode) const;
         
+        /**
+         * Returns the binary VFH histogram directly, if the histogram
+         * size matches the direction bins of the search configuration.
+         * */
+        virtual void getDrivableDirectionBins(const TreeNode& curNode, DirectionSampleTable::BinMask &drivable) const;
+        
         virtual bool validateNode(const TreeNode& node) const;
+
+        /**
+         * Returns the distance to the closest obstacle from the
+         * distance field of VFH, if maxClearance is configured.
+         * */
+        virtual double getClearance(const TreeNode& node) const;
+
+        /**
+         * Returns the radius of the footprint of VFH, including
+         * the obstacle safety distance
+         * */
+        virtual double getRobotRadius() const;
 };
 } // vfh_star namespace
 
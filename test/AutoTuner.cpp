@@ -0,0 +1,548 @@
+#include <vfh_star/VFHStar.h>
+#include <vfh_star/PlanCapture.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <limits>
+#include <cstdlib>
+#include <cstring>
+#include "TestPlanner.hpp"
+
+using namespace vfh_star;
+
+/**
+ * Tunes the search parameters on a corpus of plans.
+ *
+ *   auto_tuner [-j threads] [-n configs] [-k survivors] [-s seed] [-o dir] [capture files]
+ *
+ * The corpus consists of the plans of the given capture files, see
+ * VFHStar::setPlanCapture, or of synthetic plans on random maps if no
+ * file is given. The configuration of the first captured plan is the
+ * base configuration, the ones of the other plans are ignored.
+ *
+ * Random configurations are compared by successive halving: all are
+ * run on a small part of the corpus, the better half is run on twice
+ * as many plans, and so on, until the survivors ran on the whole
+ * corpus. Configurations are ranked by Pareto dominance on the p99
+ * latency, the mean path length of the solved plans and the success
+ * rate. The path length is used instead of the cost, as the cost
+ * depends on the tuned parameters.
+ *
+ * The Pareto optimal configurations are written as orogen
+ * configuration files with the properties search_conf and cost_conf.
+ * */
+
+typedef boost::shared_ptr<PlanRecord> PlanRecordPtr;
+
+/**
+ * The tuned parameters, applied on top of the base configuration
+ * */
+struct Parameters
+{
+    double stepDistance;
+    double angularSamplingMax;
+    int angularSamplingNominalCount;
+    double identityPositionThreshold;
+    double identityYawThreshold;
+    double discountFactor;
+    int histogramSize;
+    int maxTreeSize;
+
+    static Parameters fromConfig(const TreeSearchConf &searchConf, const VFHStarConf &costConf)
+    {
+        Parameters p;
+        p.stepDistance = searchConf.stepDistance;
+        p.angularSamplingMax = searchConf.sampleAreas.empty() ? 0 : searchConf.sampleAreas.front().angularSamplingMax;
+        p.angularSamplingNominalCount = searchConf.sampleAreas.empty() ? 1 : searchConf.sampleAreas.front().angularSamplingNominalCount;
+        p.identityPositionThreshold = searchConf.identityPositionThreshold;
+        p.identityYawThreshold = searchConf.identityYawThreshold;
+        p.discountFactor = searchConf.discountFactor;
+        p.histogramSize = costConf.vfhConf.histogramSize;
+        p.maxTreeSize = searchConf.maxTreeSize;
+        return p;
+    }
+
+    static Parameters random()
+    {
+        const int histogramSizes[] = {60, 90, 120, 180, 360};
+        const int treeSizes[] = {2000, 5000, 10000, 20000, 50000};
+
+        Parameters p;
+        p.stepDistance = uniform(0.05, 0.3);
+        p.angularSamplingMax = uniform(3.0, 20.0) * M_PI / 180.0;
+        p.angularSamplingNominalCount = 3 + rand() % 10;
+        p.identityPositionThreshold = uniform(0.3, 0.8) * p.stepDistance;
+        p.identityYawThreshold = uniform(1.0, 10.0) * M_PI / 180.0;
+        p.discountFactor = uniform(0.8, 1.0);
+        p.histogramSize = histogramSizes[rand() % (sizeof(histogramSizes) / sizeof(int))];
+        p.maxTreeSize = treeSizes[rand() % (sizeof(treeSizes) / sizeof(int))];
+        return p;
+    }
+
+    void apply(TreeSearchConf &searchConf, VFHStarConf &costConf) const
+    {
+        searchConf.stepDistance = stepDistance;
+        for(std::vector<AngleSampleConf>::iterator it = searchConf.sampleAreas.begin(); it != searchConf.sampleAreas.end(); it++)
+        {
+            it->angularSamplingMax = angularSamplingMax;
+            it->angularSamplingMin = angularSamplingMax / 4.0;
+            it->angularSamplingNominalCount = angularSamplingNominalCount;
+        }
+        searchConf.identityPositionThreshold = identityPositionThreshold;
+        searchConf.identityYawThreshold = identityYawThreshold;
+        searchConf.discountFactor = discountFactor;
+        searchConf.maxTreeSize = maxTreeSize;
+        costConf.vfhConf.histogramSize = histogramSize;
+    }
+
+private:
+    static double uniform(double min, double max)
+    {
+        return min + (max - min) * rand() / RAND_MAX;
+    }
+};
+
+struct PlanResult
+{
+    PlanResult() : latency(0), solved(false), length(0) {}
+
+    ///time of computePath in seconds
+    double latency;
+    bool solved;
+    double length;
+};
+
+struct Candidate
+{
+    Parameters parameters;
+    TreeSearchConf searchConf;
+    VFHStarConf costConf;
+
+    ///results of the first results.size() plans of the corpus
+    std::vector<PlanResult> results;
+
+    double p99Latency;
+    double meanLength;
+    double successRate;
+    int rank;
+
+    void computeStatistics()
+    {
+        std::vector<double> latencies;
+        double lengthSum = 0;
+        int solved = 0;
+        for(std::vector<PlanResult>::const_iterator it = results.begin(); it != results.end(); it++)
+        {
+            latencies.push_back(it->latency);
+            if(it->solved)
+            {
+                lengthSum += it->length;
+                solved++;
+            }
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        //nearest rank
+        const size_t p99 = std::max<size_t>(1, ceil(0.99 * latencies.size())) - 1;
+        p99Latency = latencies.empty() ? 0 : latencies[p99];
+        meanLength = solved ? lengthSum / solved : std::numeric_limits<double>::infinity();
+        successRate = results.empty() ? 0 : static_cast<double>(solved) / results.size();
+    }
+
+    bool dominates(const Candidate &other) const
+    {
+        if(p99Latency > other.p99Latency || meanLength > other.meanLength || successRate < other.successRate)
+            return false;
+        return p99Latency < other.p99Latency || meanLength < other.meanLength || successRate > other.successRate;
+    }
+
+    static bool lowerRank(const Candidate *a, const Candidate *b)
+    {
+        if(a->rank != b->rank)
+            return a->rank < b->rank;
+        if(a->successRate != b->successRate)
+            return a->successRate > b->successRate;
+        return a->meanLength < b->meanLength;
+    }
+};
+
+/**
+ * Plans a part of the corpus with the configuration of the candidate
+ * on the given snapshots of the corpus maps. The plans are taken from
+ * the shared counter nextPlan.
+ * */
+void runPlans(Candidate *candidate, const std::vector<PlanRecordPtr> *corpus, const std::vector<MapSnapshotPtr> *snapshots, int end, volatile int *nextPlan)
+{
+    TestPlanner planner;
+    planner.setSearchConf(candidate->searchConf);
+    planner.setCostConf(candidate->costConf);
+
+    bool warm = false;
+    while(true)
+    {
+        const int i = __sync_fetch_and_add(nextPlan, 1);
+        if(i >= end)
+            break;
+
+        const PlanRecord &record(*(*corpus)[i]);
+        planner.setTreeToWorld(record.treeToWorld);
+        planner.setMapSnapshot((*snapshots)[i]);
+        const base::Angle heading(base::Angle::fromRad(record.mainHeading));
+
+        //the first search of a planner allocates its lookup tables
+        if(!warm)
+        {
+            planner.computePath(record.start, heading, record.horizon);
+            warm = true;
+        }
+
+        const base::Time start = base::Time::now();
+        const TreeNode *node = planner.computePath(record.start, heading, record.horizon);
+        PlanResult &result(candidate->results[i]);
+        result.latency = (base::Time::now() - start).toSeconds();
+        result.solved = node != NULL;
+        for(; node && !node->isRoot(); node = node->getParent())
+            result.length += (node->getPosition() - node->getParent()->getPosition()).head<2>().norm();
+    }
+}
+
+/**
+ * Runs the candidate on the plans of the corpus up to end,
+ * which it did not run on yet
+ * */
+void evaluate(Candidate &candidate, const std::vector<PlanRecordPtr> &corpus, int end, int nrThreads)
+{
+    const int begin = candidate.results.size();
+    volatile int nextPlan = begin;
+    candidate.results.resize(end);
+
+    //the maps are preprocessed once for the configuration
+    //and shared between the planners of all threads
+    TestPlanner planner;
+    planner.setSearchConf(candidate.searchConf);
+    planner.setCostConf(candidate.costConf);
+    std::vector<MapSnapshotPtr> snapshots(end);
+    for(int i = begin; i < end; i++)
+        snapshots[i] = MapSnapshot::create(corpus[i]->getGridView(), planner.getVFHConf());
+
+    boost::thread_group threads;
+    for(int i = 0; i < nrThreads; i++)
+        threads.create_thread(boost::bind(&runPlans, &candidate, &corpus, &snapshots, end, &nextPlan));
+    threads.join_all();
+
+    candidate.computeStatistics();
+}
+
+/**
+ * Sets the Pareto rank of the candidates, 0 is the Pareto front
+ * */
+void rankCandidates(std::vector<Candidate *> &candidates)
+{
+    std::vector<Candidate *> unranked(candidates);
+    for(int rank = 0; !unranked.empty(); rank++)
+    {
+        std::vector<Candidate *> front;
+        std::vector<Candidate *> rest;
+        for(size_t i = 0; i < unranked.size(); i++)
+        {
+            bool dominated = false;
+            for(size_t j = 0; j < unranked.size() && !dominated; j++)
+                dominated = unranked[j]->dominates(*unranked[i]);
+
+            if(dominated)
+                rest.push_back(unranked[i]);
+            else
+                front.push_back(unranked[i]);
+        }
+
+        for(size_t i = 0; i < front.size(); i++)
+            front[i]->rank = rank;
+        unranked.swap(rest);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), Candidate::lowerRank);
+}
+
+void createSyntheticCorpus(std::vector<PlanRecordPtr> &corpus, const TreeSearchConf &searchConf, const VFHStarConf &costConf)
+{
+    const int size = 400;
+    const double densities[] = {0.01, 0.03, 0.05, 0.1};
+    const int nrDensities = sizeof(densities) / sizeof(double);
+    const int nrHeadings = 8;
+
+    for(int d = 0; d < nrDensities; d++)
+    {
+        for(int h = 0; h < nrHeadings; h++)
+        {
+            PlanRecordPtr record(new PlanRecord());
+            createMap(record->cells, size, densities[d], rand());
+            record->width = size;
+            record->height = size;
+            record->scale = 0.05;
+            record->offsetX = -10.0;
+            record->offsetY = -10.0;
+            record->obstacleClasses[TRAVERSABLE] = false;
+            record->mainHeading = 2 * M_PI * h / nrHeadings;
+            record->horizon = 3.0;
+            record->searchConf = searchConf;
+            record->costConf = costConf;
+            corpus.push_back(record);
+        }
+    }
+}
+
+const char *getScanModeName(ObstacleScanMode mode)
+{
+    switch(mode)
+    {
+        case SCAN_SPARSE:
+            return ":SCAN_SPARSE";
+        case SCAN_TILED:
+            return ":SCAN_TILED";
+        default:
+            return ":SCAN_DENSE";
+    }
+}
+
+void writeConfig(const std::string &fileName, const Candidate &candidate)
+{
+    std::ofstream out(fileName.c_str());
+    out.precision(10);
+    const TreeSearchConf &s(candidate.searchConf);
+    const VFHConf &v(candidate.costConf.vfhConf);
+
+    out << "# p99 latency " << candidate.p99Latency * 1000.0 << " ms, mean path length " << candidate.meanLength
+        << " m, success rate " << candidate.successRate << " on " << candidate.results.size() << " plans" << std::endl;
+    out << "--- name:default" << std::endl;
+    out << "search_conf:" << std::endl;
+    out << "  maxTreeSize: " << s.maxTreeSize << std::endl;
+    out << "  stepDistance: " << s.stepDistance << std::endl;
+    out << "  sampleAreas:" << std::endl;
+    for(std::vector<AngleSampleConf>::const_iterator it = s.sampleAreas.begin(); it != s.sampleAreas.end(); it++)
+    {
+        out << "  - angularSamplingMin: " << it->angularSamplingMin << std::endl;
+        out << "    angularSamplingMax: " << it->angularSamplingMax << std::endl;
+        out << "    angularSamplingNominalCount: " << it->angularSamplingNominalCount << std::endl;
+        out << "    intervalStart: " << it->intervalStart << std::endl;
+        out << "    intervalWidth: " << it->intervalWidth << std::endl;
+    }
+    out << "  discountFactor: " << s.discountFactor << std::endl;
+    out << "  identityPositionThreshold: " << s.identityPositionThreshold << std::endl;
+    out << "  identityYawThreshold: " << s.identityYawThreshold << std::endl;
+    out << "  maxSeekTime:" << std::endl;
+    out << "    microseconds: " << s.maxSeekTime.toMicroseconds() << std::endl;
+    out << "  directionBins: " << s.directionBins << std::endl;
+    out << "  directionEpsilon: " << s.directionEpsilon << std::endl;
+    out << "  maxChildrenPerExpansion: " << s.maxChildrenPerExpansion << std::endl;
+    out << "  clearanceSamplingNear: " << s.clearanceSamplingNear << std::endl;
+    out << "  clearanceSamplingFar: " << s.clearanceSamplingFar << std::endl;
+    out << "  samplingDensityMin: " << s.samplingDensityMin << std::endl;
+    out << "  samplingDensityMax: " << s.samplingDensityMax << std::endl;
+    out << "  maxStepDistance: " << s.maxStepDistance << std::endl;
+    out << "  macroStepClearance: " << s.macroStepClearance << std::endl;
+    out << "  resolutionSchedule:" << (s.resolutionSchedule.empty() ? " []" : "") << std::endl;
+    for(std::vector<SearchResolution>::const_iterator it = s.resolutionSchedule.begin(); it != s.resolutionSchedule.end(); it++)
+    {
+        out << "  - startDistance: " << it->startDistance << std::endl;
+        out << "    stepDistance: " << it->stepDistance << std::endl;
+        out << "    angularSamplingScale: " << it->angularSamplingScale << std::endl;
+        out << "    identityPositionThreshold: " << it->identityPositionThreshold << std::endl;
+        out << "    identityYawThreshold: " << it->identityYawThreshold << std::endl;
+    }
+    out << "  driveModeTransitions:" << (s.driveModeTransitions.empty() ? " []" : "") << std::endl;
+    for(std::vector<DriveModeTransition>::const_iterator it = s.driveModeTransitions.begin(); it != s.driveModeTransitions.end(); it++)
+    {
+        out << "  - fromDriveMode: " << it->fromDriveMode << std::endl;
+        out << "    toDriveMode: " << it->toDriveMode << std::endl;
+        out << "    allowed: " << (it->allowed ? "true" : "false") << std::endl;
+        out << "    penalty: " << it->penalty << std::endl;
+    }
+    out << "  minDriveModeDwell: " << s.minDriveModeDwell << std::endl;
+    out << "  budgetControl:" << std::endl;
+    out << "    targetLatency:" << std::endl;
+    out << "      microseconds: " << s.budgetControl.targetLatency.toMicroseconds() << std::endl;
+    out << "    percentile: " << s.budgetControl.percentile << std::endl;
+    out << "    window: " << s.budgetControl.window << std::endl;
+    out << "    minTreeSize: " << s.budgetControl.minTreeSize << std::endl;
+    out << "    maxTreeSize: " << s.budgetControl.maxTreeSize << std::endl;
+    out << "    minSamplingScale: " << s.budgetControl.minSamplingScale << std::endl;
+    out << "    maxHeuristicWeight: " << s.budgetControl.maxHeuristicWeight << std::endl;
+    out << "cost_conf:" << std::endl;
+    out << "  vfhConf:" << std::endl;
+    out << "    obstacleSafetyDistance: " << v.obstacleSafetyDistance << std::endl;
+    out << "    robotWidth: " << v.robotWidth << std::endl;
+    out << "    robotLength: " << v.robotLength << std::endl;
+    out << "    footprintYawBins: " << v.footprintYawBins << std::endl;
+    out << "    maxClearance: " << v.maxClearance << std::endl;
+    out << "    sweptPathCheck: " << (v.sweptPathCheck ? "true" : "false") << std::endl;
+    out << "    sweptStepLength: " << v.sweptStepLength << std::endl;
+    out << "    obstacleSenseRadius: " << v.obstacleSenseRadius << std::endl;
+    out << "    narrowThreshold: " << v.narrowThreshold << std::endl;
+    out << "    lowThreshold: " << v.lowThreshold << std::endl;
+    out << "    histogramSize: " << v.histogramSize << std::endl;
+    out << "    obstacleScanMode: " << getScanModeName(v.obstacleScanMode) << std::endl;
+    out << "  mainHeadingWeight: " << candidate.costConf.mainHeadingWeight << std::endl;
+    out << "  distanceWeight: " << candidate.costConf.distanceWeight << std::endl;
+    out << "  turningWeight: " << candidate.costConf.turningWeight << std::endl;
+
+    if(!out)
+        throw std::runtime_error("Could not write " + fileName);
+}
+
+void printCandidate(std::ostream &out, const Candidate &c)
+{
+    const Parameters &p(c.parameters);
+    out << std::setw(8) << c.p99Latency * 1000.0 << std::setw(8) << c.meanLength << std::setw(8) << c.successRate
+        << std::setw(8) << p.stepDistance << std::setw(8) << p.angularSamplingMax * 180.0 / M_PI << std::setw(4) << p.angularSamplingNominalCount
+        << std::setw(8) << p.identityPositionThreshold << std::setw(8) << p.identityYawThreshold * 180.0 / M_PI
+        << std::setw(8) << p.discountFactor << std::setw(5) << p.histogramSize << std::setw(7) << p.maxTreeSize << std::endl;
+}
+
+void printHeader(std::ostream &out)
+{
+    out << std::setw(8) << "p99 ms" << std::setw(8) << "length" << std::setw(8) << "success"
+        << std::setw(8) << "step" << std::setw(8) << "sMax" << std::setw(4) << "sN"
+        << std::setw(8) << "idPos" << std::setw(8) << "idYaw"
+        << std::setw(8) << "disc" << std::setw(5) << "hist" << std::setw(7) << "tree" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int nrThreads = std::max(1u, boost::thread::hardware_concurrency());
+    int nrCandidates = 32;
+    int minSurvivors = 8;
+    int seed = 42;
+    std::string outputDir = ".";
+    std::vector<std::string> captures;
+    for(int i = 1; i < argc; i++)
+    {
+        if(argv[i][0] == '-' && i + 1 < argc)
+        {
+            if(!strcmp(argv[i], "-j"))
+                nrThreads = atoi(argv[++i]);
+            else if(!strcmp(argv[i], "-n"))
+                nrCandidates = atoi(argv[++i]);
+            else if(!strcmp(argv[i], "-k"))
+                minSurvivors = atoi(argv[++i]);
+            else if(!strcmp(argv[i], "-s"))
+                seed = atoi(argv[++i]);
+            else if(!strcmp(argv[i], "-o"))
+                outputDir = argv[++i];
+            else
+                nrThreads = 0;
+        }
+        else
+        {
+            captures.push_back(argv[i]);
+        }
+    }
+
+    if(nrThreads < 1 || nrCandidates < 1 || minSurvivors < 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [-j threads] [-n configs] [-k survivors] [-s seed] [-o dir] [capture files]" << std::endl;
+        return 1;
+    }
+
+    //the planner prints every search to stdout, the report goes to the
+    //original stdout. Errors and warnings stay on stderr
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(NULL);
+    report.precision(3);
+    report << std::fixed;
+
+    srand(seed);
+    std::vector<PlanRecordPtr> corpus;
+    for(std::vector<std::string>::const_iterator it = captures.begin(); it != captures.end(); it++)
+    {
+        PlanCaptureReader reader(*it);
+        PlanRecordPtr record(new PlanRecord());
+        while(reader.read(*record))
+        {
+            corpus.push_back(record);
+            record.reset(new PlanRecord());
+        }
+    }
+
+    TreeSearchConf baseSearchConf;
+    VFHStarConf baseCostConf;
+    if(corpus.empty())
+    {
+        TestPlanner::getTestConfig(baseSearchConf, baseCostConf);
+        createSyntheticCorpus(corpus, baseSearchConf, baseCostConf);
+        report << "Tuning on " << corpus.size() << " synthetic plans" << std::endl;
+    }
+    else
+    {
+        baseSearchConf = corpus.front()->searchConf;
+        baseCostConf = corpus.front()->costConf;
+        report << "Tuning on " << corpus.size() << " captured plans" << std::endl;
+    }
+
+    //the order of the corpus decides which plans the
+    //early rounds run on, so it must be mixed
+    std::random_shuffle(corpus.begin(), corpus.end());
+
+    //the base configuration competes as first candidate
+    std::vector<Candidate> candidates(nrCandidates);
+    for(int i = 0; i < nrCandidates; i++)
+    {
+        Candidate &c(candidates[i]);
+        c.searchConf = baseSearchConf;
+        c.costConf = baseCostConf;
+        c.parameters = i ? Parameters::random() : Parameters::fromConfig(baseSearchConf, baseCostConf);
+        c.parameters.apply(c.searchConf, c.costConf);
+    }
+
+    std::vector<Candidate *> survivors;
+    for(std::vector<Candidate>::iterator it = candidates.begin(); it != candidates.end(); it++)
+        survivors.push_back(&*it);
+
+    //halve the survivors and double the plans each round,
+    //so that the last round runs on the whole corpus
+    int nrRounds = 1;
+    for(int n = nrCandidates; n > minSurvivors; n = (n + 1) / 2)
+        nrRounds++;
+
+    const int corpusSize = corpus.size();
+    for(int round = 0; round < nrRounds; round++)
+    {
+        const int nrPlans = std::max(std::min(corpusSize, 4), corpusSize >> (nrRounds - 1 - round));
+        const base::Time start = base::Time::now();
+        for(std::vector<Candidate *>::iterator it = survivors.begin(); it != survivors.end(); it++)
+            evaluate(**it, corpus, nrPlans, nrThreads);
+
+        rankCandidates(survivors);
+        report << "Round " << round << ": " << survivors.size() << " configurations on " << nrPlans
+               << " plans took " << (base::Time::now() - start).toSeconds() << " s" << std::endl;
+
+        if(round != nrRounds - 1)
+            survivors.resize(std::max<size_t>(minSurvivors, (survivors.size() + 1) / 2));
+    }
+
+    report << "Pareto optimal configurations:" << std::endl;
+    printHeader(report);
+    int nrWritten = 0;
+    for(std::vector<Candidate *>::const_iterator it = survivors.begin(); it != survivors.end() && (*it)->rank == 0; it++)
+    {
+        std::ostringstream fileName;
+        fileName << outputDir << "/pareto_" << nrWritten << ".yml";
+        writeConfig(fileName.str(), **it);
+        printCandidate(report, **it);
+        nrWritten++;
+    }
+    report << "Wrote " << nrWritten << " configurations to " << outputDir << std::endl;
+
+    //the base configuration may have been dropped early
+    if(static_cast<int>(candidates.front().results.size()) < corpusSize)
+        evaluate(candidates.front(), corpus, corpusSize, nrThreads);
+    report << "Base configuration:" << std::endl;
+    printHeader(report);
+    printCandidate(report, candidates.front());
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <vfh_star/BudgetController.hpp>
+#include <iostream>
+#include <string>
+#include <cmath>
+
+using namespace vfh_star;
+
+/**
+ * Feeds synthetic search times into the budget controller and checks
+ * the node budget, the overload and the sampling scale and heuristic
+ * weight derived from it.
+ *
+ * The target is 10 ms over a window of 4 searches. With the 90%
+ * percentile of 4 searches, the slowest search of the window decides.
+ * */
+
+const int maxTreeSize = 20000;
+
+BudgetControlConf getConfig()
+{
+    BudgetControlConf conf;
+    conf.targetLatency = base::Time::fromMilliseconds(10);
+    conf.percentile = 0.9;
+    conf.window = 4;
+    conf.minTreeSize = 500;
+    conf.minSamplingScale = 0.5;
+    conf.maxHeuristicWeight = 1.5;
+    return conf;
+}
+
+/**
+ * Adds a search with the given setup and search time in
+ * microseconds and 1000 nodes
+ * */
+void addSearch(BudgetController &controller, int setupTime, int searchTime)
+{
+    controller.addSearch(base::Time::fromMicroseconds(setupTime), base::Time::fromMicroseconds(searchTime), 500, 1000);
+}
+
+int check(const BudgetController &controller, const std::string &name, int nodeBudget, double overload)
+{
+    const double samplingScale = 1.0 - overload * 0.5;
+    const double heuristicWeight = 1.0 + overload * 0.5;
+    if(controller.getNodeBudget() != nodeBudget || fabs(controller.getStats().overload - overload) > 1e-9
+        || fabs(controller.getSamplingScale() - samplingScale) > 1e-9 || fabs(controller.getHeuristicWeight() - heuristicWeight) > 1e-9)
+    {
+        std::cout << name << ": budget " << controller.getNodeBudget() << ", overload " << controller.getStats().overload
+                  << ", sampling scale " << controller.getSamplingScale() << ", heuristic weight " << controller.getHeuristicWeight()
+                  << " instead of " << nodeBudget << ", " << overload << ", " << samplingScale << ", " << heuristicWeight << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    int errors = 0;
+
+    //without a target, searches are ignored
+    BudgetController disabled;
+    disabled.setConfig(BudgetControlConf(), maxTreeSize);
+    addSearch(disabled, 1000, 200000);
+    errors += check(disabled, "Disabled", maxTreeSize, 0.0);
+
+    BudgetController controller;
+    controller.setConfig(getConfig(), maxTreeSize);
+    errors += check(controller, "First search", maxTreeSize, 0.0);
+
+    //1 ms setup and 1 us per node leave 9000 nodes
+    addSearch(controller, 1000, 2000);
+    errors += check(controller, "1 us per node", 9000, 0.0);
+
+    //0.1 us per node would allow more than the maximum tree size
+    BudgetController idle;
+    idle.setConfig(getConfig(), maxTreeSize);
+    addSearch(idle, 100, 200);
+    errors += check(idle, "0.1 us per node", maxTreeSize, 0.0);
+
+    //100 us per node leave 90 nodes, the budget stays at the
+    //minimum and the rest is overload
+    addSearch(controller, 1000, 101000);
+    errors += check(controller, "100 us per node", 500, 1.0 - 90.0 / 500.0);
+
+    //the slow search decides until it left the window
+    for(int i = 0; i < 3; i++)
+    {
+        addSearch(controller, 1000, 2000);
+        errors += check(controller, "Slow search in the window", 500, 1.0 - 90.0 / 500.0);
+    }
+    addSearch(controller, 1000, 2000);
+    errors += check(controller, "Slow search out of the window", 9000, 0.0);
+
+    //an unchanged configuration keeps the measurements
+    controller.setConfig(getConfig(), maxTreeSize);
+    errors += check(controller, "Unchanged configuration", 9000, 0.0);
+
+    //a setup beyond the target leaves no nodes
+    addSearch(controller, 20000, 21000);
+    errors += check(controller, "Setup beyond the target", 500, 1.0);
+
+    //a changed configuration resets the controller
+    BudgetControlConf conf = getConfig();
+    conf.maxTreeSize = 5000;
+    controller.setConfig(conf, maxTreeSize);
+    errors += check(controller, "Changed configuration", 5000, 0.0);
+    addSearch(controller, 1000, 2000);
+    errors += check(controller, "Budget limit of the configuration", 5000, 0.0);
+
+    std::cout << errors << " errors" << std::endl;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+#include <vfh_star/ConfigurationSpace.hpp>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace vfh_star;
+
+/**
+ * Checks that the configuration space is conservative.
+ *
+ * A single obstacle cell is placed at every offset around the robot.
+ * For every yaw bin, the robot is sampled at several positions within
+ * its cell and yaws within the bin. If any sampled footprint touches
+ * the obstacle cell, the configuration space has to report a collision.
+ *
+ * Afterwards a randomly changed and shifted map is updated
+ * incrementally and compared against a complete computation.
+ * */
+
+const int gridSize = 25;
+const int robotCell = 12;
+const double scale = 0.1;
+const double length = 1.0;
+const double width = 0.5;
+const int yawBins = 16;
+
+/**
+ * Returns true if the footprint of the robot at position x, y (in cells)
+ * with the given yaw touches the obstacle cell
+ * */
+bool touches(double x, double y, double yaw, int obstacleX, int obstacleY)
+{
+    const double halfLength = length / 2.0 / scale;
+    const double halfWidth = width / 2.0 / scale;
+    const int samples = 8;
+    for(int i = 0; i <= samples; i++)
+    {
+        for(int j = 0; j <= samples; j++)
+        {
+            const double dx = obstacleX + i / static_cast<double>(samples) - x;
+            const double dy = obstacleY + j / static_cast<double>(samples) - y;
+            if(fabs(dx * cos(yaw) + dy * sin(yaw)) <= halfLength
+                && fabs(-dx * sin(yaw) + dy * cos(yaw)) <= halfWidth)
+                return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the number of cells and yaw bins in which the
+ * configuration spaces differ
+ * */
+int countDifferences(const ConfigurationSpace &a, const ConfigurationSpace &b, int gridWidth, int gridHeight)
+{
+    int differences = 0;
+    for(int y = 0; y < gridHeight; y++)
+    {
+        for(int x = 0; x < gridWidth; x++)
+        {
+            for(int bin = 0; bin < yawBins; bin++)
+            {
+                if(a.isColliding(x, y, bin * M_PI / yawBins) != b.isColliding(x, y, bin * M_PI / yawBins))
+                    differences++;
+            }
+        }
+    }
+    return differences;
+}
+
+int checkUpdate()
+{
+    const int gridWidth = 90;
+    const int gridHeight = 70;
+    ObstacleBitmap obstacles;
+    obstacles.resize(gridWidth, gridHeight, 1);
+    srand(42);
+    for(int i = 0; i < 100; i++)
+        obstacles.setObstacle(rand() % gridWidth, rand() % gridHeight, true);
+
+    ConfigurationSpace cspace;
+    cspace.compute(obstacles, scale, length, width, yawBins);
+
+    int errors = 0;
+    for(int step = 0; step < 10; step++)
+    {
+        //shift like a rolling window. The cells at both borders
+        //changed, the exposed ones and the ones next to the outside
+        const int dx = step % 3 - 1;
+        const int dy = step % 4 - 2;
+        const int borderX = std::max(1, abs(dx));
+        const int borderY = std::max(1, abs(dy));
+        obstacles.shift(dx, dy);
+        cspace.shift(dx, dy);
+        cspace.update(obstacles, 0, 0, borderX - 1, gridHeight - 1);
+        cspace.update(obstacles, gridWidth - borderX, 0, gridWidth - 1, gridHeight - 1);
+        cspace.update(obstacles, 0, 0, gridWidth - 1, borderY - 1);
+        cspace.update(obstacles, 0, gridHeight - borderY, gridWidth - 1, gridHeight - 1);
+
+        //change a few obstacles
+        const int x = rand() % (gridWidth - 5);
+        const int y = rand() % (gridHeight - 5);
+        for(int i = 0; i < 5; i++)
+            obstacles.setObstacle(x + rand() % 5, y + rand() % 5, rand() % 2);
+        cspace.update(obstacles, x, y, x + 4, y + 4);
+
+        ConfigurationSpace expected;
+        expected.compute(obstacles, scale, length, width, yawBins);
+        const int differences = countDifferences(cspace, expected, gridWidth, gridHeight);
+        if(differences)
+        {
+            std::cout << "Update " << step << " differs from the complete computation in " << differences << " cells" << std::endl;
+            errors++;
+        }
+    }
+    return errors;
+}
+
+int main()
+{
+    const double yawResolution = M_PI / yawBins;
+    const int range = ceil(sqrt(length * length + width * width) / 2.0 / scale) + 1;
+    int errors = 0;
+    int collisions = 0;
+    int checks = 0;
+
+    for(int oy = -range; oy <= range; oy++)
+    {
+        for(int ox = -range; ox <= range; ox++)
+        {
+            ObstacleBitmap obstacles;
+            obstacles.resize(gridSize, gridSize);
+            obstacles.setObstacle(robotCell + ox, robotCell + oy, true);
+
+            ConfigurationSpace cspace;
+            cspace.compute(obstacles, scale, length, width, yawBins);
+
+            for(int bin = 0; bin < yawBins; bin++)
+            {
+                bool touching = false;
+                for(int k = -2; k <= 2 && !touching; k++)
+                {
+                    //stay just inside of the bin
+                    const double yaw = (bin + k * 0.499 / 2.0) * yawResolution;
+                    for(int i = 0; i < 4 && !touching; i++)
+                    {
+                        for(int j = 0; j < 4 && !touching; j++)
+                            touching = touches(robotCell + (i + 0.5) / 4.0, robotCell + (j + 0.5) / 4.0, yaw, robotCell + ox, robotCell + oy);
+                    }
+                }
+
+                const bool colliding = cspace.isColliding(robotCell, robotCell, bin * yawResolution);
+                checks++;
+                if(colliding)
+                    collisions++;
+                if(touching && !colliding)
+                {
+                    std::cout << "Obstacle at offset " << ox << " " << oy << " is not detected in yaw bin " << bin << std::endl;
+                    errors++;
+                }
+            }
+        }
+    }
+
+    std::cout << "Checked " << checks << " obstacle offsets and yaw bins, " << collisions << " collisions, " << errors << " missed" << std::endl;
+
+    errors += checkUpdate();
+    return errors ? 1 : 0;
+}
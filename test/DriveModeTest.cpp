@@ -0,0 +1,274 @@
+#include <iostream>
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cmath>
+#include <sstream>
+#define private public
+#include <vfh_star/TreeSearch.h>
+#include "TestPlanner.hpp"
+
+using namespace vfh_star;
+
+/**
+ * Checks the drive mode transitions of the search with two drive modes.
+ *
+ * The straight mode is cheap on straight steps and expensive on turns,
+ * the turning mode the other way round. The goal has to be reached
+ * after a turn, a straight part and another turn, so the search
+ * switches between the modes. Both switches have a penalty, the
+ * switch from the straight to the turning mode may be forbidden.
+ *
+ * The complete tree is checked for forbidden switches, switches before
+ * minDriveModeDwell steps and the step costs including the penalties.
+ * The compiled transitions, getAllowedDriveModes and
+ * getDriveModeSwitchPenalty are checked directly.
+ * */
+
+const int STRAIGHT = 0;
+const int TURNING = 1;
+const double toTurningPenalty = 0.2;
+const double toStraightPenalty = 0.3;
+const int minDwell = 3;
+
+/**
+ * Searches a path on an empty plane from the origin, facing along x,
+ * to the line y = 1, facing along x again
+ * */
+class TwoModeSearch : public TreeSearch
+{
+public:
+    TwoModeSearch() : straight(1.0, 1.0, "Straight"), turning(0.1, 1.5, "Turning")
+    {
+        addDriveMode(straight);
+        addDriveMode(turning);
+    }
+
+    const TreeNode *plan()
+    {
+        return compute(base::Pose());
+    }
+
+    virtual bool isTerminalNode(const TreeNode& node) const
+    {
+        return node.getPosition().y() >= 1.0 && fabs(node.getYaw().getRad()) < M_PI / 12;
+    }
+
+    virtual double getHeuristic(const TreeNode &node) const
+    {
+        return std::max(0.0, 1.0 - node.getPosition().y());
+    }
+
+    virtual AngleIntervals getNextPossibleDirections(const TreeNode& curNode) const
+    {
+        return AngleIntervals(1, base::AngleSegment(base::Angle::fromRad(0), 2 * M_PI));
+    }
+
+    TestDriveMode straight;
+    TestDriveMode turning;
+};
+
+TreeSearchConf getConfig(int dwell, bool forbidTurning)
+{
+    TreeSearchConf conf;
+    conf.maxTreeSize = 20000;
+    conf.stepDistance = 0.1;
+    conf.identityPositionThreshold = 0.1;
+    conf.identityYawThreshold = 10 * M_PI / 180.0;
+    conf.minDriveModeDwell = dwell;
+
+    AngleSampleConf global;
+    global.angularSamplingMin = 45 * M_PI / 180.0;
+    global.angularSamplingMax = 45 * M_PI / 180.0;
+    global.angularSamplingNominalCount = 5;
+    global.intervalStart = 0;
+    global.intervalWidth = 2 * M_PI;
+    conf.sampleAreas.clear();
+    conf.sampleAreas.push_back(global);
+
+    DriveModeTransition toTurning;
+    toTurning.fromDriveMode = STRAIGHT;
+    toTurning.toDriveMode = TURNING;
+    toTurning.allowed = !forbidTurning;
+    toTurning.penalty = toTurningPenalty;
+    conf.driveModeTransitions.push_back(toTurning);
+
+    DriveModeTransition toStraight;
+    toStraight.fromDriveMode = TURNING;
+    toStraight.toDriveMode = STRAIGHT;
+    toStraight.penalty = toStraightPenalty;
+    conf.driveModeTransitions.push_back(toStraight);
+    return conf;
+}
+
+/**
+ * Returns the number of steps the drive mode of the node was used for,
+ * or -1 if it was used since the root, where the drive mode is unknown
+ * */
+int getDwell(const TreeNode &node)
+{
+    int dwell = 0;
+    const TreeNode *it = &node;
+    for(; !it->isRoot() && it->getDriveModeNr() == node.getDriveModeNr(); it = it->getParent())
+        dwell++;
+    return it->isRoot() ? -1 : dwell;
+}
+
+struct TreeStats
+{
+    TreeStats() : switches(0), earlySwitches(0), errors(0) {}
+    int switches;
+    int earlySwitches;
+    int errors;
+};
+
+/**
+ * Checks the switches from the node to its children and
+ * the allowed drive modes and penalties of the node
+ * */
+void checkNode(const TwoModeSearch &search, const TreeNode &node, bool forbidTurning, TreeStats &stats)
+{
+    const std::vector<TreeNode *> &children(node.getChildren());
+    for(std::vector<TreeNode *>::const_iterator it = children.begin(); it != children.end(); it++)
+    {
+        const TreeNode &child(**it);
+        checkNode(search, child, forbidTurning, stats);
+
+        const int from = node.getDriveModeNr();
+        const int to = child.getDriveModeNr();
+        const TestDriveMode &mode(to == STRAIGHT ? search.straight : search.turning);
+        const double turned = fabs((child.getYaw() - node.getYaw()).getRad());
+        double expectedCost = mode.getDistanceWeight() * (child.getPosition() - node.getPosition()).norm() + mode.getTurnWeight() * turned;
+
+        //the drive mode of the root is not known, its
+        //children never switch
+        if(!node.isRoot() && from != to)
+        {
+            stats.switches++;
+            const int dwell = getDwell(node);
+            if(dwell >= 0 && dwell < minDwell)
+                stats.earlySwitches++;
+
+            if(from == STRAIGHT && forbidTurning)
+            {
+                std::cout << "Forbidden switch at " << child.getPosition().transpose() << std::endl;
+                stats.errors++;
+            }
+            expectedCost += to == TURNING ? toTurningPenalty : toStraightPenalty;
+        }
+
+        if(fabs(child.getCostFromParent() - expectedCost) > 1e-5)
+        {
+            std::cout << "Step to " << child.getPosition().transpose() << " costs " << child.getCostFromParent() << " instead of " << expectedCost << std::endl;
+            stats.errors++;
+        }
+    }
+
+    //the allowed drive modes only depend on the dwell
+    //and the transitions of the drive mode of the node
+    uint64_t expectedModes = ~static_cast<uint64_t>(0);
+    if(!node.isRoot())
+    {
+        const int dwell = getDwell(node);
+        if(search.getSearchConf().minDriveModeDwell > 0 && dwell >= 0 && dwell < search.getSearchConf().minDriveModeDwell)
+            expectedModes = 1 << node.getDriveModeNr();
+        else
+            expectedModes = node.getDriveModeNr() == STRAIGHT && forbidTurning ? 1 << STRAIGHT : 3;
+    }
+    if(search.getAllowedDriveModes(node) != expectedModes)
+    {
+        std::cout << "Node at " << node.getPosition().transpose() << " allows the drive modes " << search.getAllowedDriveModes(node) << " instead of " << expectedModes << std::endl;
+        stats.errors++;
+    }
+
+    //the penalty does not depend on the dwell
+    for(int to = STRAIGHT; to <= TURNING; to++)
+    {
+        double expectedPenalty = 0.0;
+        if(!node.isRoot() && node.getDriveModeNr() != to)
+            expectedPenalty = to == TURNING ? toTurningPenalty : toStraightPenalty;
+        if(search.getDriveModeSwitchPenalty(node, to) != expectedPenalty)
+        {
+            std::cout << "Switch penalty from " << static_cast<int>(node.getDriveModeNr()) << " to " << to << " is " << search.getDriveModeSwitchPenalty(node, to) << std::endl;
+            stats.errors++;
+        }
+    }
+}
+
+TreeStats checkSearch(int dwell, bool forbidTurning)
+{
+    TwoModeSearch search;
+    search.setSearchConf(getConfig(dwell, forbidTurning));
+    TreeStats stats;
+    if(!search.plan())
+    {
+        std::cout << "No path found with a dwell of " << dwell << std::endl;
+        stats.errors++;
+        return stats;
+    }
+
+    //compiled transitions: only the straight mode
+    //may be restricted
+    const uint64_t straightModes = forbidTurning ? 1 << STRAIGHT : 3;
+    if(search.allowedDriveModes.size() != 2 || search.allowedDriveModes[STRAIGHT] != straightModes || search.allowedDriveModes[TURNING] != 3)
+    {
+        std::cout << "The transitions were compiled wrong" << std::endl;
+        stats.errors++;
+    }
+
+    checkNode(search, *search.getTree().getRootNode(), forbidTurning, stats);
+    std::cout << "Dwell " << dwell << (forbidTurning ? ", no switch to turning: " : ": ") << search.getTree().getSize() << " nodes, "
+              << stats.switches << " switches, " << stats.earlySwitches << " before " << minDwell << " steps" << std::endl;
+    return stats;
+}
+
+int main()
+{
+    int errors = 0;
+
+    const TreeStats forbidden = checkSearch(0, true);
+    errors += forbidden.errors;
+    if(forbidden.switches == 0)
+    {
+        std::cout << "The tree without switches to turning contains no switches" << std::endl;
+        errors++;
+    }
+
+    //without a dwell, the modes are switched after less than
+    //minDwell steps. Otherwise the dwell check below tests nothing
+    const TreeStats free = checkSearch(0, false);
+    errors += free.errors;
+    if(free.earlySwitches == 0)
+    {
+        std::cout << "The tree without a dwell contains no early switches" << std::endl;
+        errors++;
+    }
+
+    const TreeStats dwell = checkSearch(minDwell, false);
+    errors += dwell.errors + dwell.earlySwitches;
+    if(dwell.switches == 0)
+    {
+        std::cout << "The tree with a dwell contains no switches" << std::endl;
+        errors++;
+    }
+
+    //transitions to unknown drive modes are rejected
+    TwoModeSearch invalid;
+    TreeSearchConf conf = getConfig(0, false);
+    conf.driveModeTransitions[0].toDriveMode = 2;
+    invalid.setSearchConf(conf);
+    try
+    {
+        invalid.compileDriveModeTransitions();
+        std::cout << "A transition to an unknown drive mode was accepted" << std::endl;
+        errors++;
+    }
+    catch(const std::runtime_error &e)
+    {
+    }
+
+    std::cout << errors << " errors" << std::endl;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+#include <vfh_star/VFHStar.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+#include <cstdlib>
+#include "TestPlanner.hpp"
+
+using namespace vfh_star;
+
+/**
+ * Runs several planners in parallel on one shared map snapshot
+ * and compares their results to the ones of a single planner.
+ * */
+
+const int nrThreads = 8;
+const int nrRuns = 4;
+const int nrHeadings = 8;
+
+/**
+ * Test planner without turn costs, with smaller trees,
+ * that plans on the shared snapshot
+ * */
+class StressTestPlanner : public TestPlanner
+{
+public:
+    StressTestPlanner(const MapSnapshotPtr &snapshot) : TestPlanner(0.0)
+    {
+        configure();
+        TreeSearchConf conf = getSearchConf();
+        conf.maxTreeSize = 5000;
+        setSearchConf(conf);
+
+        setMapSnapshot(snapshot);
+    }
+
+    /**
+     * Returns the cost of the best path for the given heading,
+     * or -1 if none was found
+     * */
+    double plan(const base::Angle &heading)
+    {
+        base::Pose start;
+        start.orientation = Eigen::Quaterniond::Identity();
+        const TreeNode *node = computePath(start, heading, 4.0);
+        return node ? node->getCost() : -1;
+    }
+};
+
+void runPlanner(const MapSnapshotPtr &snapshot, const std::vector<double> &expected, int &failures)
+{
+    StressTestPlanner planner(snapshot);
+    for(int run = 0; run < nrRuns; run++)
+    {
+        for(int i = 0; i < nrHeadings; i++)
+        {
+            if(planner.plan(base::Angle::fromRad(2 * M_PI * i / nrHeadings)) != expected[i])
+                failures++;
+        }
+    }
+}
+
+int main()
+{
+    //400 x 400 cells with random obstacles, the robot area stays free
+    const int size = 400;
+    std::vector<uint8_t> cells;
+    createMap(cells, size, 0.02);
+
+    GridView view(&cells[0], size, size, size, 0.05, -10.0, -10.0);
+    view.setObstacleClass(TRAVERSABLE, false);
+
+    TreeSearchConf searchConf;
+    VFHStarConf costConf;
+    TestPlanner::getTestConfig(searchConf, costConf);
+    const MapSnapshotPtr snapshot(MapSnapshot::create(view, costConf.vfhConf));
+
+    //the snapshot owns its cells
+    std::fill(cells.begin(), cells.end(), OBSTACLE);
+
+    std::vector<double> expected;
+    int solved = 0;
+    {
+        StressTestPlanner planner(snapshot);
+        for(int i = 0; i < nrHeadings; i++)
+        {
+            expected.push_back(planner.plan(base::Angle::fromRad(2 * M_PI * i / nrHeadings)));
+            if(expected.back() >= 0)
+                solved++;
+        }
+    }
+
+    //if no plan finds a path, all planners agree trivially
+    if(!solved)
+    {
+        std::cout << "The single planner found no path, the comparison is meaningless" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> failures(nrThreads, 0);
+    boost::thread_group threads;
+    base::Time startTime = base::Time::now();
+    for(int i = 0; i < nrThreads; i++)
+        threads.create_thread(boost::bind(&runPlanner, snapshot, boost::cref(expected), boost::ref(failures[i])));
+    threads.join_all();
+    base::Time endTime = base::Time::now();
+
+    int totalFailures = 0;
+    for(int i = 0; i < nrThreads; i++)
+        totalFailures += failures[i];
+
+    std::cout << nrThreads << " planners x " << nrRuns * nrHeadings << " plans took " << endTime - startTime
+              << ", " << solved << " of " << nrHeadings << " headings solved, " << totalFailures << " results differ" << std::endl;
+
+    return totalFailures ? 1 : 0;
+}
@@ -0,0 +1,448 @@
+#include <vfh_star/VFHStar.h>
+#include <vfh_star/NNLookup.hpp>
+#include <base/Time.hpp>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <new>
+#include "TestPlanner.hpp"
+
+using namespace vfh_star;
+
+/**
+ * Measures the hot components of the planner in isolation:
+ * the duplicate detection, the VFH histogram, the open list,
+ * the direction sampling and the trajectory building.
+ *
+ * Every benchmark reports the time and the number of heap
+ * allocations per operation, so that optimizations of single
+ * components can be measured one by one.
+ * */
+
+static size_t allocations = 0;
+
+#if __cplusplus >= 201103L
+void *operator new(std::size_t size)
+#else
+void *operator new(std::size_t size) throw(std::bad_alloc)
+#endif
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+#if __cplusplus >= 201103L
+void operator delete(void *p) noexcept
+#else
+void operator delete(void *p) throw()
+#endif
+{
+    free(p);
+}
+
+/**
+ * Runs setup() untimed and run() timed, until at least minTime was
+ * measured or maxTime passed including the setups, and prints the
+ * time and allocations per operation. run() returns the number of
+ * operations it did.
+ * */
+template <class Benchmark>
+void measure(const std::string &name, Benchmark &benchmark)
+{
+    const base::Time minTime = base::Time::fromSeconds(0.2);
+    const base::Time maxTime = base::Time::fromSeconds(2.0);
+    const base::Time firstStart = base::Time::now();
+    base::Time time;
+    size_t allocs = 0;
+    long ops = 0;
+    while(!ops || (time < minTime && base::Time::now() - firstStart < maxTime))
+    {
+        benchmark.setup();
+        const size_t startAllocs = allocations;
+        const base::Time start = base::Time::now();
+        ops += benchmark.run();
+        time = time + (base::Time::now() - start);
+        allocs += allocations - startAllocs;
+    }
+
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::left << std::setw(40) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(1) << time.toSeconds() * 1e9 / ops
+              << std::setw(12) << std::setprecision(3) << static_cast<double>(allocs) / ops << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+void printHeader(const std::string &title)
+{
+    std::cout << std::endl << title << std::endl;
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "ns/op" << std::setw(12) << "allocs/op" << std::endl;
+}
+
+std::string label(const std::string &name, double value)
+{
+    std::ostringstream s;
+    s << name << value;
+    return s.str();
+}
+
+/**
+ * Poses in the given area around the origin
+ * */
+void createPoses(std::vector<base::Pose> &poses, int count, double range)
+{
+    poses.clear();
+    srand(23);
+    for(int i = 0; i < count; i++)
+    {
+        base::Pose pose;
+        pose.position = base::Vector3d(rand() * range / RAND_MAX - range / 2.0, rand() * range / RAND_MAX - range / 2.0, 0);
+        pose.orientation = Eigen::AngleAxisd(rand() * 2 * M_PI / RAND_MAX, base::Vector3d::UnitZ());
+        poses.push_back(pose);
+    }
+}
+
+struct NNLookupInsert
+{
+    NNLookup &lookup;
+    std::vector<TreeNode> &nodes;
+
+    NNLookupInsert(NNLookup &lookup, std::vector<TreeNode> &nodes) : lookup(lookup), nodes(nodes) {}
+
+    void setup()
+    {
+        lookup.clear();
+    }
+
+    long run()
+    {
+        for(std::vector<TreeNode>::iterator it = nodes.begin(); it != nodes.end(); it++)
+            lookup.setNode(&*it);
+        return nodes.size();
+    }
+};
+
+struct NNLookupFind
+{
+    NNLookup &lookup;
+    std::vector<TreeNode> &nodes;
+    long found;
+
+    NNLookupFind(NNLookup &lookup, std::vector<TreeNode> &nodes) : lookup(lookup), nodes(nodes), found(0) {}
+
+    void setup()
+    {
+    }
+
+    long run()
+    {
+        for(std::vector<TreeNode>::const_iterator it = nodes.begin(); it != nodes.end(); it++)
+            found += lookup.getNodeWithinBounds(*it) != NULL;
+        return nodes.size();
+    }
+};
+
+struct NNLookupClear
+{
+    NNLookup &lookup;
+    std::vector<TreeNode> &nodes;
+
+    NNLookupClear(NNLookup &lookup, std::vector<TreeNode> &nodes) : lookup(lookup), nodes(nodes) {}
+
+    void setup()
+    {
+        for(std::vector<TreeNode>::iterator it = nodes.begin(); it != nodes.end(); it++)
+            lookup.setNode(&*it);
+    }
+
+    long run()
+    {
+        lookup.clear();
+        return 1;
+    }
+};
+
+void benchmarkNNLookup()
+{
+    printHeader("NNLookup on a 10m x 10m area, resolution 0.03m and 1.5 deg");
+    const int nodeCounts[] = {10000, 100000, 1000000};
+    const int nrNodeCounts = sizeof(nodeCounts) / sizeof(int);
+    for(int i = 0; i < nrNodeCounts; i++)
+    {
+        std::vector<base::Pose> poses;
+        createPoses(poses, nodeCounts[i], 10.0);
+        std::vector<TreeNode> nodes;
+        nodes.reserve(poses.size());
+        for(std::vector<base::Pose>::const_iterator it = poses.begin(); it != poses.end(); it++)
+            nodes.push_back(TreeNode(*it, BinaryAngle::fromRad(it->getYaw()), NULL, 0));
+
+        NNLookup lookup(1.0, 0.03, 1.5 * M_PI / 180.0);
+        const double density = nodeCounts[i] / 100.0;
+
+        NNLookupInsert insert(lookup, nodes);
+        measure(label("insert, nodes/m^2 ", density), insert);
+        NNLookupFind find(lookup, nodes);
+        measure(label("lookup, nodes/m^2 ", density), find);
+        NNLookupClear clear(lookup, nodes);
+        measure(label("clear, nodes/m^2 ", density), clear);
+    }
+}
+
+struct VFHDirections
+{
+    const VFH &vfh;
+    const std::vector<base::Pose> &poses;
+    size_t intervals;
+
+    VFHDirections(const VFH &vfh, const std::vector<base::Pose> &poses) : vfh(vfh), poses(poses), intervals(0) {}
+
+    void setup()
+    {
+    }
+
+    long run()
+    {
+        for(std::vector<base::Pose>::const_iterator it = poses.begin(); it != poses.end(); it++)
+            intervals += vfh.getNextPossibleDirections(*it).size();
+        return poses.size();
+    }
+};
+
+void benchmarkVFH()
+{
+    printHeader("VFH::getNextPossibleDirections on a 400x400 grid, 0.05m");
+    std::vector<base::Pose> poses;
+    createPoses(poses, 2000, 15.0);
+
+    const double densities[] = {0.001, 0.01, 0.05, 0.1};
+    const int nrDensities = sizeof(densities) / sizeof(double);
+    const double radii[] = {1.0, 2.0, 4.0};
+    const int nrRadii = sizeof(radii) / sizeof(double);
+    std::vector<uint8_t> cells;
+    for(int d = 0; d < nrDensities; d++)
+    {
+        createMap(cells, 400, densities[d]);
+        GridView view(&cells[0], 400, 400, 400, 0.05, -10.0, -10.0);
+        view.setObstacleClass(TRAVERSABLE, false);
+
+        for(int r = 0; r < nrRadii; r++)
+        {
+            VFHConf conf;
+            conf.obstacleSafetyDistance = 0.1;
+            conf.robotWidth = 0.5;
+            conf.obstacleSenseRadius = radii[r];
+            VFH vfh;
+            vfh.setConfig(conf);
+            vfh.setNewGridView(view);
+
+            VFHDirections directions(vfh, poses);
+            std::ostringstream name;
+            name << "density " << densities[d] << ", radius " << radii[r];
+            measure(name.str(), directions);
+        }
+    }
+}
+
+typedef TreeSearch::OpenList OpenList;
+
+struct OpenListPush
+{
+    OpenList &list;
+    const std::vector<Scalar> &keys;
+
+    OpenListPush(OpenList &list, const std::vector<Scalar> &keys) : list(list), keys(keys) {}
+
+    void setup()
+    {
+        list.clear();
+    }
+
+    long run()
+    {
+        for(std::vector<Scalar>::const_iterator it = keys.begin(); it != keys.end(); it++)
+            list.insert(std::make_pair(*it, static_cast<TreeNode *>(NULL)));
+        return keys.size();
+    }
+};
+
+struct OpenListPop
+{
+    OpenList &list;
+    const std::vector<Scalar> &keys;
+
+    OpenListPop(OpenList &list, const std::vector<Scalar> &keys) : list(list), keys(keys) {}
+
+    void setup()
+    {
+        list.clear();
+        for(std::vector<Scalar>::const_iterator it = keys.begin(); it != keys.end(); it++)
+            list.insert(std::make_pair(*it, static_cast<TreeNode *>(NULL)));
+    }
+
+    long run()
+    {
+        const long ops = list.size();
+        while(!list.empty())
+            list.erase(list.begin());
+        return ops;
+    }
+};
+
+/**
+ * Changes the keys of the entries, like a cost update
+ * of a subtree does
+ * */
+struct OpenListUpdate
+{
+    OpenList &list;
+    const std::vector<Scalar> &keys;
+    std::vector<OpenList::iterator> entries;
+
+    OpenListUpdate(OpenList &list, const std::vector<Scalar> &keys) : list(list), keys(keys) {}
+
+    void setup()
+    {
+        list.clear();
+        entries.clear();
+        for(std::vector<Scalar>::const_iterator it = keys.begin(); it != keys.end(); it++)
+            entries.push_back(list.insert(std::make_pair(*it, static_cast<TreeNode *>(NULL))));
+    }
+
+    long run()
+    {
+        for(size_t i = 0; i < entries.size(); i++)
+        {
+            const Scalar key = entries[i]->first * 0.9;
+            list.erase(entries[i]);
+            entries[i] = list.insert(std::make_pair(key, static_cast<TreeNode *>(NULL)));
+        }
+        return entries.size();
+    }
+};
+
+void benchmarkOpenList()
+{
+    printHeader("Open list");
+    const int sizes[] = {1000, 20000, 200000};
+    const int nrSizes = sizeof(sizes) / sizeof(int);
+    for(int i = 0; i < nrSizes; i++)
+    {
+        std::vector<Scalar> keys(sizes[i]);
+        srand(42);
+        for(size_t j = 0; j < keys.size(); j++)
+            keys[j] = rand() * 10.0 / RAND_MAX;
+
+        OpenList list;
+        OpenListPush push(list, keys);
+        measure(label("push, entries ", sizes[i]), push);
+        OpenListPop pop(list, keys);
+        measure(label("pop, entries ", sizes[i]), pop);
+        OpenListUpdate update(list, keys);
+        measure(label("update, entries ", sizes[i]), update);
+    }
+}
+
+class BenchmarkPlanner : public TestPlanner
+{
+public:
+    BenchmarkPlanner()
+    {
+        configure();
+    }
+
+    using VFHStar::getDirectionsFromIntervals;
+    using VFHStar::getVFH;
+};
+
+struct DirectionsFromIntervals
+{
+    BenchmarkPlanner &planner;
+    const std::vector<base::Pose> &poses;
+    const std::vector<TreeSearch::AngleIntervals> &intervals;
+    size_t directions;
+
+    DirectionsFromIntervals(BenchmarkPlanner &planner, const std::vector<base::Pose> &poses, const std::vector<TreeSearch::AngleIntervals> &intervals)
+        : planner(planner), poses(poses), intervals(intervals), directions(0) {}
+
+    void setup()
+    {
+    }
+
+    long run()
+    {
+        for(size_t i = 0; i < poses.size(); i++)
+            directions += planner.getDirectionsFromIntervals(BinaryAngle::fromRad(poses[i].getYaw()), intervals[i]).size();
+        return poses.size();
+    }
+};
+
+struct BuildTrajectories
+{
+    const BenchmarkPlanner &planner;
+    const TreeNode *node;
+    size_t trajectories;
+
+    BuildTrajectories(const BenchmarkPlanner &planner, const TreeNode *node) : planner(planner), node(node), trajectories(0) {}
+
+    void setup()
+    {
+    }
+
+    long run()
+    {
+        for(int i = 0; i < 100; i++)
+            trajectories += planner.buildTrajectoriesTo(node, Eigen::Affine3d::Identity()).size();
+        return 100;
+    }
+};
+
+void benchmarkPlanner()
+{
+    std::vector<uint8_t> cells;
+    createMap(cells, 400, 0.05);
+    GridView view(&cells[0], 400, 400, 400, 0.05, -10.0, -10.0);
+    view.setObstacleClass(TRAVERSABLE, false);
+
+    BenchmarkPlanner planner;
+    planner.setNewGridView(view);
+
+    printHeader("TreeSearch::getDirectionsFromIntervals, density 0.05");
+    {
+        std::vector<base::Pose> poses;
+        createPoses(poses, 2000, 15.0);
+        std::vector<TreeSearch::AngleIntervals> intervals;
+        for(std::vector<base::Pose>::const_iterator it = poses.begin(); it != poses.end(); it++)
+            intervals.push_back(planner.getVFH().getNextPossibleDirections(*it));
+
+        DirectionsFromIntervals directions(planner, poses, intervals);
+        measure("directions from intervals", directions);
+    }
+
+    printHeader("TreeSearch::buildTrajectoriesTo, density 0.05");
+    {
+        const TreeNode *node = planner.computePath(base::Pose(), base::Angle::fromRad(0), 2.0);
+        if(!node)
+        {
+            std::cout << "No path found" << std::endl;
+            return;
+        }
+
+        BuildTrajectories build(planner, node);
+        measure(label("path of nodes ", node->getDepth() + 1), build);
+    }
+}
+
+int main()
+{
+    benchmarkNNLookup();
+    benchmarkVFH();
+    benchmarkOpenList();
+    benchmarkPlanner();
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <vfh_star/ConcurrentNNLookup.hpp>
+#include <base/Time.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+#include <cstdlib>
+#include <numeric>
+
+using namespace vfh_star;
+
+/**
+ * Measures the insert and lookup throughput of the
+ * ConcurrentNNLookup with different numbers of threads.
+ * */
+
+const int nrNodes = 1000000;
+
+void insertNodes(ConcurrentNNLookup *lookup, const std::vector<TreeNode> *nodes, int start, int step)
+{
+    for(int i = start; i < nrNodes; i += step)
+        lookup->setNode((*nodes)[i]);
+}
+
+void lookupNodes(const ConcurrentNNLookup *lookup, const std::vector<TreeNode> *nodes, int *found, int start, int step)
+{
+    int count = 0;
+    for(int i = start; i < nrNodes; i += step)
+    {
+        if(lookup->getNodeWithinBounds((*nodes)[i]) >= 0)
+            count++;
+    }
+    found[start] = count;
+}
+
+/**
+ * Runs the function with the given number of threads and
+ * returns the throughput in million operations per second
+ * */
+template <class Func>
+double measure(int nrThreads, Func func)
+{
+    base::Time start = base::Time::now();
+    boost::thread_group threads;
+    for(int i = 0; i < nrThreads; i++)
+        threads.create_thread(boost::bind(func, i, nrThreads));
+    threads.join_all();
+
+    return nrNodes / (base::Time::now() - start).toSeconds() / 1e6;
+}
+
+int main()
+{
+    //nodes on a 50m x 50m area, about every fourth one is a duplicate
+    std::vector<TreeNode> nodes;
+    nodes.reserve(nrNodes);
+    srand(42);
+    for(int i = 0; i < nrNodes; i++)
+    {
+        base::Pose pose;
+        pose.position = base::Vector3d(rand() * 50.0 / RAND_MAX - 25.0, rand() * 50.0 / RAND_MAX - 25.0, 0);
+        pose.orientation = Eigen::AngleAxisd(rand() * 2 * M_PI / RAND_MAX, base::Vector3d::UnitZ());
+        nodes.push_back(TreeNode(pose, base::Angle::fromRad(0), NULL, 0));
+        nodes.back().setCost(rand() % 1000);
+    }
+
+    ConcurrentNNLookup lookup(0.05, 10.0 / 180.0 * M_PI, nrNodes);
+
+    std::cout << "Million operations per second with " << nrNodes << " nodes" << std::endl;
+    std::cout << "threads\tinsert\tlookup" << std::endl;
+    const int threadCounts[] = {1, 2, 4, 8, 16};
+    const int nrThreadCounts = sizeof(threadCounts) / sizeof(int);
+    for(int i = 0; i < nrThreadCounts; i++)
+    {
+        const int nrThreads = threadCounts[i];
+        lookup.clear();
+        const double insert = measure(nrThreads, boost::bind(&insertNodes, &lookup, &nodes, _1, _2));
+
+        std::vector<int> found(nrThreads, 0);
+        const double lookups = measure(nrThreads, boost::bind(&lookupNodes, &lookup, &nodes, &found[0], _1, _2));
+
+        std::cout << nrThreads << "\t" << insert << "\t" << lookups;
+        if(std::accumulate(found.begin(), found.end(), 0) != nrNodes)
+            std::cout << " [nodes missing]";
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <vfh_star/VFHStar.h>
+#include <vfh_star/PlanCapture.hpp>
+#include <vfh_star/Trace.hpp>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include "TestPlanner.hpp"
+
+using namespace vfh_star;
+
+/**
+ * Captures plans into a file and replays them offline.
+ *
+ *   plan_replay capture <file>
+ * plans on a map with moving obstacles and records every plan, and
+ *   plan_replay replay <file>
+ * replays the recorded plans and reports the differences in cost,
+ * path and tree size together with the planning times. With
+ *   plan_replay replay <file> <trace.json>
+ * the timeline of the replay is written as Chrome trace, including
+ * the phases of every node expansion.
+ *
+ * The drive modes are code and are not part of a capture, so a
+ * replay of a capture from a robot needs its drive modes instead
+ * of the TestDriveMode.
+ * */
+
+int capture(const char *fileName)
+{
+    const int size = 400;
+    const int nrPlans = 20;
+    const int nrObstacles = 400;
+
+    std::vector<uint8_t> cells(size * size, TRAVERSABLE);
+    std::vector<int> obstacles(nrObstacles);
+    srand(42);
+    for(int i = 0; i < nrObstacles; i++)
+        obstacles[i] = rand() % (size * size);
+
+    TestPlanner planner;
+    planner.configure();
+    PlanCaptureWriter writer(fileName);
+    planner.setPlanCapture(&writer);
+
+    for(int i = 0; i < nrPlans; i++)
+    {
+        //move some obstacles, like a sensor update would
+        for(int j = 0; j < nrObstacles; j++)
+        {
+            cells[obstacles[j]] = TRAVERSABLE;
+            if(j % 10 == i % 10)
+                obstacles[j] = rand() % (size * size);
+        }
+        for(int j = 0; j < nrObstacles; j++)
+            cells[obstacles[j]] = OBSTACLE;
+
+        //keep the start free
+        for(int y = size / 2 - 10; y < size / 2 + 10; y++)
+            for(int x = size / 2 - 10; x < size / 2 + 10; x++)
+                cells[y * size + x] = TRAVERSABLE;
+
+        GridView view(&cells[0], size, size, size, 0.05, -10.0, -10.0);
+        view.setObstacleClass(TRAVERSABLE, false);
+        planner.setNewGridView(view);
+
+        base::Pose start;
+        start.position = base::Vector3d(0.01 * i, 0, 0);
+        planner.computePath(start, base::Angle::fromRad(2 * M_PI * i / nrPlans), 2.0);
+    }
+
+    planner.setPlanCapture(NULL);
+    std::cout << "Captured " << nrPlans << " plans into " << fileName << std::endl;
+    return 0;
+}
+
+int replay(const char *fileName, const char *traceFileName)
+{
+    if(traceFileName)
+        Trace::start(Trace::EXPANSIONS);
+
+    PlanCaptureReader reader(fileName);
+    TestPlanner planner;
+    PlanRecord record;
+
+    int nrPlans = 0;
+    int differentCosts = 0;
+    int differentPaths = 0;
+    int differentTrees = 0;
+    base::Time recordedTime;
+    base::Time replayTime;
+    while(reader.read(record))
+    {
+        //only the search is timed, like in the record
+        planner.prepareReplay(record);
+        const base::Time startTime = base::Time::now();
+        const TreeNode *node = planner.computePath(record.start, base::Angle::fromRad(record.mainHeading), record.horizon);
+        const base::Time time = base::Time::now() - startTime;
+        planner.buildTrajectoriesTo(node, Eigen::Affine3d::Identity());
+
+        PlanRecord result;
+        result.setResult(node, planner.getTree().getSize());
+
+        const bool sameCost = fabs(result.cost - record.cost) <= 1e-9 * std::max(1.0, fabs(record.cost));
+        bool samePath = result.path.size() == record.path.size();
+        for(size_t i = 0; samePath && i < result.path.size(); i++)
+            samePath = (result.path[i] - record.path[i]).norm() < 1e-6;
+
+        if(!sameCost || !samePath || result.treeSize != record.treeSize)
+        {
+            std::cout << "Plan " << nrPlans << ": cost " << result.cost << " instead of " << record.cost
+                      << ", " << result.path.size() << " instead of " << record.path.size() << " nodes in path, tree size "
+                      << result.treeSize << " instead of " << record.treeSize << std::endl;
+        }
+
+        differentCosts += !sameCost;
+        differentPaths += !samePath;
+        differentTrees += result.treeSize != record.treeSize;
+        recordedTime = recordedTime + record.planningTime;
+        replayTime = replayTime + time;
+        nrPlans++;
+    }
+
+    if(traceFileName)
+    {
+        Trace::stop();
+        Trace::writeChromeTrace(traceFileName);
+        std::cout << "Wrote the trace to " << traceFileName << ", " << Trace::getDroppedEvents() << " events were dropped" << std::endl;
+    }
+
+    std::cout << "Replayed " << nrPlans << " plans in " << replayTime.toMilliseconds() << " ms, recorded "
+              << recordedTime.toMilliseconds() << " ms" << std::endl;
+    std::cout << differentCosts << " costs, " << differentPaths << " paths and " << differentTrees << " tree sizes differ" << std::endl;
+
+    return (differentCosts || differentPaths || differentTrees) ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 3 || (strcmp(argv[1], "capture") && strcmp(argv[1], "replay"))
+       || argc > (strcmp(argv[1], "replay") ? 3 : 4))
+    {
+        std::cerr << "Usage: " << argv[0] << " capture <file>" << std::endl;
+        std::cerr << "       " << argv[0] << " replay <file> [<trace.json>]" << std::endl;
+        return 1;
+    }
+
+    if(!strcmp(argv[1], "capture"))
+        return capture(argv[2]);
+
+    return replay(argv[2], argc == 4 ? argv[3] : NULL);
+}
@@ -0,0 +1,152 @@
+#include <vfh_star/VFHStar.h>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include "TestPlanner.hpp"
+
+using namespace vfh_star;
+
+/**
+ * Compares the paths chosen by a float build (FLOAT_PRECISION)
+ * with the ones of a double build on the benchmark maps.
+ *
+ * The double build writes its results with
+ *   precision_test write <file>
+ * and the float build compares against them with
+ *   precision_test compare <file>
+ * The comparison fails if a cost differs by more than rounding. A
+ * different path only passes as a tie, i.e. if its cost is the same.
+ * */
+
+const int nrHeadings = 8;
+
+/**
+ * Result of one plan: the cost and the node positions
+ * from the root to the chosen node
+ * */
+struct PlanResult
+{
+    double cost;
+    std::vector<base::Vector3d> path;
+};
+
+void runPlans(std::vector<PlanResult> &results)
+{
+    const int size = 400;
+    const double densities[] = {0.001, 0.01, 0.05};
+    const int nrDensities = sizeof(densities) / sizeof(double);
+
+    std::vector<uint8_t> cells;
+    TestPlanner planner;
+    planner.configure();
+    for(int d = 0; d < nrDensities; d++)
+    {
+        createMap(cells, size, densities[d]);
+        GridView view(&cells[0], size, size, size, 0.05, -10.0, -10.0);
+        view.setObstacleClass(TRAVERSABLE, false);
+        planner.setNewGridView(view);
+
+        for(int i = 0; i < nrHeadings; i++)
+        {
+            base::Pose start;
+            const TreeNode *node = planner.computePath(start, base::Angle::fromRad(2 * M_PI * i / nrHeadings), 2.0);
+
+            PlanResult result;
+            result.cost = node ? node->getCost() : -1;
+            for(; node && !node->isRoot(); node = node->getParent())
+                result.path.insert(result.path.begin(), node->getPosition());
+            results.push_back(result);
+        }
+    }
+}
+
+void write(const std::vector<PlanResult> &results, std::ostream &out)
+{
+    out.precision(10);
+    for(std::vector<PlanResult>::const_iterator it = results.begin(); it != results.end(); it++)
+    {
+        out << it->cost << " " << it->path.size();
+        for(std::vector<base::Vector3d>::const_iterator p = it->path.begin(); p != it->path.end(); p++)
+            out << " " << p->x() << " " << p->y();
+        out << std::endl;
+    }
+}
+
+bool read(std::vector<PlanResult> &results, std::istream &in)
+{
+    PlanResult result;
+    size_t nrNodes;
+    while(in >> result.cost >> nrNodes)
+    {
+        result.path.resize(nrNodes);
+        for(size_t i = 0; i < nrNodes; i++)
+        {
+            result.path[i].z() = 0;
+            if(!(in >> result.path[i].x() >> result.path[i].y()))
+                return false;
+        }
+        results.push_back(result);
+    }
+    return in.eof();
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 3 || (strcmp(argv[1], "write") && strcmp(argv[1], "compare")))
+    {
+        std::cerr << "Usage: " << argv[0] << " write|compare <file>" << std::endl;
+        return 1;
+    }
+
+    std::vector<PlanResult> results;
+    runPlans(results);
+
+    if(!strcmp(argv[1], "write"))
+    {
+        std::ofstream out(argv[2]);
+        write(results, out);
+        return out ? 0 : 1;
+    }
+
+    std::ifstream in(argv[2]);
+    std::vector<PlanResult> expected;
+    if(!read(expected, in) || expected.size() != results.size())
+    {
+        std::cerr << "Could not read the results from " << argv[2] << std::endl;
+        return 1;
+    }
+
+    //a float build may only change the costs by rounding. A path may
+    //only differ, if the other path has the same cost: equally cheap
+    //nodes can be expanded in a different order. Any other difference
+    //fails the test
+    const double costTolerance = 1e-6;
+    int ties = 0;
+    int failures = 0;
+    double maxCostError = 0;
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const double costError = fabs(results[i].cost - expected[i].cost);
+        maxCostError = std::max(maxCostError, costError);
+        const bool sameCost = costError <= costTolerance * std::max(1.0, fabs(expected[i].cost));
+
+        bool samePath = results[i].path.size() == expected[i].path.size();
+        for(size_t j = 0; samePath && j < results[i].path.size(); j++)
+            samePath = (results[i].path[j] - expected[i].path[j]).head<2>().norm() < 1e-3;
+
+        if(!sameCost)
+        {
+            std::cout << "Plan " << i << " has cost " << results[i].cost << " instead of " << expected[i].cost
+                      << (samePath ? " on the same path" : " on a different path") << std::endl;
+            failures++;
+        }
+        else if(!samePath)
+            ties++;
+    }
+
+    std::cout << "Scalar has " << sizeof(Scalar) << " bytes, TreeNode has " << sizeof(TreeNode) << " bytes" << std::endl;
+    std::cout << ties << " of " << results.size() << " paths differ with equal cost, " << failures << " plans differ, max cost error " << maxCostError << std::endl;
+
+    return failures ? 1 : 0;
+}
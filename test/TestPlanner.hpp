@@ -0,0 +1,141 @@
+#ifndef VFH_STAR_TEST_PLANNER_HPP
+#define VFH_STAR_TEST_PLANNER_HPP
+
+#include <vfh_star/VFHStar.h>
+#include <cstdlib>
+#include <vector>
+#include <string>
+
+/**
+ * Map classes, drive mode, planner and maps shared by the
+ * test and benchmark executables.
+ * */
+
+const int OBSTACLE = 1;
+const int TRAVERSABLE = 2;
+
+/**
+ * Drives straight into every direction. The cost is distanceWeight
+ * times the travelled distance plus turnWeight times the turned angle.
+ * */
+class TestDriveMode : public vfh_star::DriveMode
+{
+public:
+    explicit TestDriveMode(double turnWeight, double distanceWeight = 1.0, const std::string &name = "TestMode")
+        : DriveMode(name), distanceWeight(distanceWeight), turnWeight(turnWeight)
+    {
+    }
+
+    virtual double getCostForNode(const vfh_star::ProjectedPose& projection, const base::Angle& direction, const vfh_star::TreeNode& parentNode) const
+    {
+        return distanceWeight * (projection.pose.position - parentNode.getPosition()).norm() + turnWeight * projection.angleTurned;
+    }
+
+    virtual bool projectPose(vfh_star::ProjectedPose &result, const vfh_star::TreeNode& curNode, const base::Angle& moveDirection, double distance) const
+    {
+        result.pose.orientation = Eigen::AngleAxisd(moveDirection.getRad(), base::Vector3d::UnitZ());
+        result.pose.position = curNode.getPose().position + result.pose.orientation * base::Vector3d(distance, 0, 0);
+        result.angleTurned = fabs((moveDirection - curNode.getYaw()).getRad());
+        result.nextPoseExists = true;
+        return true;
+    }
+
+    virtual void setTrajectoryParameters(base::Trajectory& tr) const
+    {
+        tr.speed = 1.0;
+    }
+
+    double getDistanceWeight() const
+    {
+        return distanceWeight;
+    }
+
+    double getTurnWeight() const
+    {
+        return turnWeight;
+    }
+
+private:
+    double distanceWeight;
+    double turnWeight;
+};
+
+/**
+ * VFHStar with a TestDriveMode. The default turn weight of 0.1 makes
+ * the cheapest path unique on the test maps.
+ * */
+class TestPlanner : public vfh_star::VFHStar
+{
+public:
+    explicit TestPlanner(double turnWeight = 0.1) : driveMode(turnWeight)
+    {
+        addDriveMode(driveMode);
+    }
+
+    /**
+     * Sets the configuration of the tests in the given configurations:
+     * trees of up to 20000 nodes, steps of 0.1 m, sampling over the
+     * full circle, and 180 histogram bins for a robot of 0.5 m width.
+     * Other fields are left unchanged.
+     * */
+    static void getTestConfig(vfh_star::TreeSearchConf &searchConf, vfh_star::VFHStarConf &costConf)
+    {
+        searchConf.maxTreeSize = 20000;
+        searchConf.stepDistance = 0.1;
+        searchConf.identityPositionThreshold = 0.06;
+        searchConf.identityYawThreshold = 3 * M_PI / 180.0;
+
+        vfh_star::AngleSampleConf global;
+        global.angularSamplingMin = 5 * M_PI / 360.0;
+        global.angularSamplingMax = 10 * M_PI / 180.0;
+        global.angularSamplingNominalCount = 5;
+        global.intervalStart = 0;
+        global.intervalWidth = 2 * M_PI;
+        searchConf.sampleAreas.clear();
+        searchConf.sampleAreas.push_back(global);
+
+        costConf.vfhConf.obstacleSafetyDistance = 0.1;
+        costConf.vfhConf.robotWidth = 0.5;
+        costConf.vfhConf.obstacleSenseRadius = 1.0;
+        costConf.vfhConf.histogramSize = 180;
+        costConf.vfhConf.lowThreshold = 2000.0;
+    }
+
+    /**
+     * Applies the test configuration to the planner
+     * */
+    void configure()
+    {
+        vfh_star::TreeSearchConf searchConf = getSearchConf();
+        vfh_star::VFHStarConf costConf = getCostConf();
+        getTestConfig(searchConf, costConf);
+        setSearchConf(searchConf);
+        setCostConf(costConf);
+    }
+
+private:
+    TestDriveMode driveMode;
+};
+
+/**
+ * Fills a size x size map with randomly placed obstacle cells of the
+ * given density. The cells within 10 cells of the center stay free
+ * for the robot.
+ * */
+inline void createMap(std::vector<uint8_t> &cells, int size, double obstacleDensity, unsigned int seed = 42)
+{
+    cells.assign(size * size, TRAVERSABLE);
+    srand(seed);
+    for(int y = 0; y < size; y++)
+    {
+        for(int x = 0; x < size; x++)
+        {
+            const int dx = x - size / 2;
+            const int dy = y - size / 2;
+            if(dx * dx + dy * dy > 100 && rand() < obstacleDensity * RAND_MAX)
+                cells[y * size + x] = OBSTACLE;
+        }
+    }
+}
+
+#endif // VFH_STAR_TEST_PLANNER_HPP
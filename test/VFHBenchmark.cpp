@@ -0,0 +1,169 @@
+#include <vfh_star/VFH.h>
+#include <base/Time.hpp>
+#include <iostream>
+#include <cstdlib>
+
+using namespace vfh_star;
+
+/**
+ * Compares the obstacle scan modes of the histogram generation
+ * on grids with different obstacle densities and sizes.
+ * */
+
+const int UNKNOWN = 0;
+const int OBSTACLE = 1;
+const int TRAVERSABLE = 2;
+
+void fillGrid(envire::TraversabilityGrid &trGrid, double obstacleDensity)
+{
+    envire::TraversabilityGrid::ArrayType &trData(trGrid.getGridData(envire::TraversabilityGrid::TRAVERSABILITY));
+    std::fill(trData.data(), trData.data() + trData.num_elements(), TRAVERSABLE);
+
+    srand(42);
+    for(size_t y = 0; y < trGrid.getCellSizeY(); y++)
+    {
+        for(size_t x = 0; x < trGrid.getCellSizeX(); x++)
+        {
+            if(rand() < obstacleDensity * RAND_MAX)
+                trData[y][x] = OBSTACLE;
+        }
+    }
+}
+
+double measure(VFH &vfh, const std::vector<base::Pose> &poses, std::vector<std::vector<base::AngleSegment> > &results)
+{
+    results.clear();
+    base::Time start = base::Time::now();
+    for(std::vector<base::Pose>::const_iterator it = poses.begin(); it != poses.end(); it++)
+        results.push_back(vfh.getNextPossibleDirections(*it));
+
+    return (base::Time::now() - start).toSeconds() * 1e6 / poses.size();
+}
+
+bool isEqual(const std::vector<base::AngleSegment> &a, const std::vector<base::AngleSegment> &b)
+{
+    if(a.size() != b.size())
+        return false;
+
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        if(fabs((a[i].getStart() - b[i].getStart()).getRad()) > 1e-9 || fabs(a[i].getWidth() - b[i].getWidth()) > 1e-9)
+            return false;
+    }
+    return true;
+}
+
+void createGrid(envire::TraversabilityGrid &trGrid)
+{
+    envire::TraversabilityClass unknown;
+    envire::TraversabilityClass drivable(1.0);
+    envire::TraversabilityClass obstacle(0.0);
+
+    trGrid.setTraversabilityClass(UNKNOWN, unknown);
+    trGrid.setTraversabilityClass(OBSTACLE, obstacle);
+    trGrid.setTraversabilityClass(TRAVERSABLE, drivable);
+}
+
+/**
+ * Poses all over the map, including the border areas
+ * */
+void createPoses(double mapSize, std::vector<base::Pose> &poses)
+{
+    poses.clear();
+    srand(23);
+    const double range = mapSize - 1.0;
+    for(int i = 0; i < 2000; i++)
+    {
+        base::Pose pose;
+        pose.position = base::Vector3d(rand() * range / RAND_MAX - range / 2.0, rand() * range / RAND_MAX - range / 2.0, 0);
+        pose.orientation = Eigen::AngleAxisd(rand() * 2 * M_PI / RAND_MAX, base::Vector3d::UnitZ());
+        poses.push_back(pose);
+    }
+}
+
+/**
+ * Measures all scan modes and prints one line of results.
+ * The results of the modes are compared to the dense scan.
+ * */
+void runModes(const envire::TraversabilityGrid &trGrid, VFHConf conf, const std::vector<base::Pose> &poses)
+{
+    const ObstacleScanMode modes[] = {SCAN_DENSE, SCAN_SPARSE, SCAN_TILED};
+    const int nrModes = sizeof(modes) / sizeof(ObstacleScanMode);
+
+    std::vector<std::vector<base::AngleSegment> > denseResults;
+    double denseTime = 0;
+    for(int i = 0; i < nrModes; i++)
+    {
+        VFH vfh;
+        conf.obstacleScanMode = modes[i];
+        vfh.setConfig(conf);
+        vfh.setNewTraversabilityGrid(&trGrid);
+
+        std::vector<std::vector<base::AngleSegment> > results;
+        const double time = measure(vfh, poses, results);
+        if(modes[i] == SCAN_DENSE)
+        {
+            denseResults = results;
+            denseTime = time;
+        }
+
+        //the obstacles are summed up in a different order, so
+        //rounding may flip single bins at the threshold
+        int mismatches = 0;
+        for(size_t j = 0; j < results.size(); j++)
+        {
+            if(!isEqual(denseResults[j], results[j]))
+                mismatches++;
+        }
+
+        std::cout << "\t" << time << " (x" << denseTime / time << ")";
+        if(mismatches)
+            std::cout << " [" << mismatches << " differ]";
+    }
+    std::cout << std::endl;
+}
+
+int main()
+{
+    std::vector<base::Pose> poses;
+    VFHConf conf;
+
+    std::cout << "Time per histogram in us on a 1000x1000 grid, sense radius 2m" << std::endl;
+    std::cout << "density\tdense\tsparse\ttiled" << std::endl;
+    {
+        envire::TraversabilityGrid trGrid(1000, 1000, 0.05, 0.05, -25.0, -25.0);
+        createGrid(trGrid);
+        createPoses(50.0, poses);
+        conf.obstacleSenseRadius = 2.0;
+
+        const double densities[] = {0.001, 0.01, 0.05, 0.1, 0.3};
+        const int nrDensities = sizeof(densities) / sizeof(double);
+        for(int i = 0; i < nrDensities; i++)
+        {
+            fillGrid(trGrid, densities[i]);
+            std::cout << densities[i];
+            runModes(trGrid, conf, poses);
+        }
+    }
+
+    //on large grids the rows of the sense area are far apart in memory
+    std::cout << "Time per histogram in us on a 4000x4000 grid, density 0.05" << std::endl;
+    std::cout << "radius\tdense\tsparse\ttiled" << std::endl;
+    {
+        envire::TraversabilityGrid trGrid(4000, 4000, 0.05, 0.05, -100.0, -100.0);
+        createGrid(trGrid);
+        createPoses(200.0, poses);
+        fillGrid(trGrid, 0.05);
+
+        const double radii[] = {1.0, 2.5, 4.5};
+        const int nrRadii = sizeof(radii) / sizeof(double);
+        for(int i = 0; i < nrRadii; i++)
+        {
+            conf.obstacleSenseRadius = radii[i];
+            std::cout << radii[i];
+            runModes(trGrid, conf, poses);
+        }
+    }
+
+    return 0;
+}